@@ -1,17 +1,22 @@
 #include "GUI/MiniGUI.h"
 #include "GUI/Color.h"
 #include "DisasterParser.h"
+#include "Disaster/Solver.h"
 #include "ginteractors.h"
+#include <atomic>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <cmath>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include "filelib.h"
 #include "strlib.h"
 #include "gthread.h"
+#include "gtimer.h"
 #include "simpio.h"
 using namespace std;
 using namespace MiniGUI;
@@ -69,6 +74,12 @@ namespace {
     /* Max length of a string in a label. */
     const string::size_type kMaxLength = 3;
 
+    /* How often to show solver progress while a solve is running. */
+    const double kProgressFPS = 30;
+
+    /* How long to spend on the quick heuristic before proving the answer optimal. */
+    const double kHeuristicSeconds = 0.25;
+
     /* Geometry information for drawing the network. */
     struct Geometry {
         /* Range of X and Y values in the data set, used for
@@ -294,46 +305,89 @@ namespace {
         return result;
     }
 
-    /* Uses binary search to find the optimal number of cities to use for disaster
-     * preparedness, populating the result field with the minimum group of cities
-     * that ended up being needed.
+    /* Finds the optimal number of cities to use for disaster preparedness with the
+     * given backend, populating the result field with the minimum group of cities
+     * that ended up being needed and stats with what the solver did.
      */
-    void solveOptimally(const DisasterTest& test, Set<string>& result) {
-        /* The variable 'low' is the lowest number that might be feasible.
-         * The variable 'high' is the highest number that we know is feasible.
-         */
-        int low = 0, high = test.network.size();
+    void solveOptimally(const DisasterTest& test, Disaster::SolverBackend backend,
+                        Set<string>& result, Disaster::SolverStats& stats) {
+        Disaster::SolverOptions options;
+        options.backend = backend;
+        result = minimumEmergencySupplies(test.network, options, &stats);
+    }
 
-        /* Begin with a feasible solution that uses as many cities as we'd like. */
-        auto returned = placeEmergencySupplies(test.network, high);
-        if (returned != Nothing) result = returned.value();
+    /* What a background solve has figured out so far. The worker thread writes it and
+     * the GUI thread reads it on every timer tick.
+     */
+    struct SolveState {
+        atomic<bool>      cancel{false};  // Set by the Cancel button
+        atomic<long long> nodes{0};       // Search nodes explored so far
+
+        mutex       lock;                 // Guards everything below
+        Set<string> best;                 // Best cover found so far
+        bool        exact    = false;     // Whether the exact search has started
+        int         probing  = -1;        // Cover size the exact search is looking for
+        bool        finished = false;
+        string      outcome;              // Summary once finished
+    };
 
-        while (low < high) {
-            /* This line looks weird, but it's designed to avoid integer overflows
-             * on large inputs. The idea that (high + low) can overflow, but
-             * (high - low) / 2 never will.
-             */
-            int mid = low + (high - low) / 2;
-            auto thisResult = placeEmergencySupplies(test.network, mid);
+    /* Solves the network on the calling thread, reporting into state. First the
+     * heuristic finds a good cover quickly, then the exact search tries to beat it,
+     * showing each smaller cover it finds as it goes.
+     */
+    void solveInBackground(const DisasterTest& test, SolveState& state) {
+        Disaster::RoadGraph graph(test.network);
+
+        Disaster::AnytimeOptions heuristic;
+        heuristic.seconds = kHeuristicSeconds;
+        heuristic.cancel  = &state.cancel;
+        auto best = Disaster::findGoodCover(graph, heuristic, [&](const vector<Disaster::CityId>& cover) {
+            lock_guard<mutex> lock(state.lock);
+            state.best = graph.namesOf(cover);
+        });
+
+        {
+            lock_guard<mutex> lock(state.lock);
+            state.best = graph.namesOf(best);
+            state.exact = true;
+            state.probing = int(best.size()) - 1;
+        }
 
-            /* If this option works, decrease high to it, since we know all is good. */
-            if (thisResult != Nothing) {
-                high = mid;
-                result = thisResult.value(); // Remember this result for later.
+        Disaster::SolverOptions options;
+        options.nodeCounter = &state.nodes;
+        options.onImprovement = [&](const vector<Disaster::CityId>& cover) {
+            lock_guard<mutex> lock(state.lock);
+            if (cover.size() < state.best.size()) {
+                state.best = graph.namesOf(cover);
+                state.probing = int(cover.size()) - 1;
             }
-            /* Otherwise, rule out anything less than or equal to it. */
-            else {
-                low = mid + 1;
+        };
+        auto result = Disaster::findMinimumCoverBy(graph, chrono::steady_clock::time_point::max(),
+                                                   &state.cancel, options);
+
+        lock_guard<mutex> lock(state.lock);
+        if (result.status != Disaster::SolveStatus::TIMED_OUT && result.cover.size() <= state.best.size()) {
+            state.best = graph.namesOf(result.cover);
+        }
+        if (result.status == Disaster::SolveStatus::OPTIMAL) {
+            state.outcome = "Optimal: " + pluralize(state.best.size(), "city", "cities") + ".";
+        } else {
+            state.outcome = "Cancelled. Best plan uses " + pluralize(state.best.size(), "city", "cities") + ".";
+            if (result.lowerBound > 0) {
+                state.outcome += " Every plan needs at least " + pluralize(result.lowerBound, "city", "cities") + ".";
             }
         }
+        state.finished = true;
     }
 
     class DisasterGUI: public ProblemHandler {
     public:
         DisasterGUI(GWindow& window);
+        ~DisasterGUI();
 
         void actionPerformed(GObservable* source) override;
         void changeOccurredIn(GObservable* source) override;
+        void timerFired() override;
 
     protected:
         void repaint() override;
@@ -342,21 +396,33 @@ namespace {
         /* Dropdown of all the problems to choose from. */
         Temporary<GComboBox> mProblems;
 
-        /* Button to trigger the solver. */
+        /* Buttons to start and stop the solver. */
         Temporary<GButton> mSolve;
+        Temporary<GButton> mCancel;
+
+        /* What the solver is up to. */
+        Temporary<GLabel> mStatus;
 
         /* Current network and solution. */
         DisasterTest    mNetwork;
         Set<string> mSelected;
 
+        /* The solve in progress, if any. */
+        shared_ptr<SolveState> mSolveState;
+        thread                 mWorker;
+        GTimer                 mTimer;
+
         /* Loads the world with the given name. */
         void loadWorld(const string& filename);
 
-        /* Computes an optimal solution. */
+        /* Starts computing an optimal solution in the background. */
         void solve();
+
+        /* Waits for the background solve to end and restores the controls. */
+        void finishSolve();
     };
 
-    DisasterGUI::DisasterGUI(GWindow& window) : ProblemHandler(window) {
+    DisasterGUI::DisasterGUI(GWindow& window) : ProblemHandler(window), mTimer(1000.0 / kProgressFPS) {
         GComboBox* choices = new GComboBox();
         for (const string& file: sampleProblems(kBasePath)) {
             choices->addItem(file);
@@ -365,10 +431,22 @@ namespace {
 
         mProblems = Temporary<GComboBox>(choices, window, "SOUTH");
         mSolve    = Temporary<GButton>(new GButton("Solve"), window, "SOUTH");
+        mCancel   = Temporary<GButton>(new GButton("Cancel"), window, "SOUTH");
+        mStatus   = Temporary<GLabel>(new GLabel(""), window, "SOUTH");
+        mCancel->setEnabled(false);
 
         loadWorld(choices->getSelectedItem());
     }
 
+    DisasterGUI::~DisasterGUI() {
+        /* Don't leave the worker running against a handler that's gone. */
+        if (mWorker.joinable()) {
+            mSolveState->cancel = true;
+            mWorker.join();
+        }
+        mTimer.stop();
+    }
+
     void DisasterGUI::changeOccurredIn(GObservable* source) {
         if (source == mProblems) {
             loadWorld(mProblems->getSelectedItem());
@@ -378,9 +456,39 @@ namespace {
     void DisasterGUI::actionPerformed(GObservable* source) {
         if (source == mSolve) {
             solve();
+        } else if (source == mCancel && mSolveState) {
+            mSolveState->cancel = true;
+            mCancel->setEnabled(false);
         }
     }
 
+    void DisasterGUI::timerFired() {
+        if (!mSolveState) return;
+
+        bool finished;
+        {
+            lock_guard<mutex> lock(mSolveState->lock);
+            mSelected = mSolveState->best;
+            finished  = mSolveState->finished;
+
+            if (finished) {
+                mStatus->setText(mSolveState->outcome);
+            } else if (!mSolveState->exact) {
+                mStatus->setText("Finding a good plan... best so far: " +
+                                 pluralize(mSelected.size(), "city", "cities") + ".");
+            } else if (mSolveState->probing < 0) {
+                mStatus->setText("Checking that no cities are needed (" +
+                                 to_string(mSolveState->nodes.load()) + " nodes explored).");
+            } else {
+                mStatus->setText("Looking for a plan with " + pluralize(mSolveState->probing, "city", "cities") +
+                                 " (" + to_string(mSolveState->nodes.load()) + " nodes explored).");
+            }
+        }
+
+        if (finished) finishSolve();
+        requestRepaint();
+    }
+
     void DisasterGUI::repaint() {
         visualizeNetwork(window(), mNetwork, mSelected);
     }
@@ -391,24 +499,41 @@ namespace {
 
         mNetwork = loadDisaster(input);
         mSelected.clear();
+        mStatus->setText("");
         requestRepaint();
     }
 
     void DisasterGUI::solve() {
         /* Clear out any old solution. We're going to get a new one. */
         mSelected.clear();
+        mStatus->setText("");
 
-        /* Disable all controls until the operation finishes. */
+        /* Disable the controls until the operation finishes, except for Cancel. */
         mSolve->setEnabled(false);
         mProblems->setEnabled(false);
+        mCancel->setEnabled(true);
+
+        /* The search runs on its own thread so the window stays responsive; the timer
+         * picks up its progress at a steady frame rate.
+         */
+        mSolveState = make_shared<SolveState>();
+        mWorker = thread([state = mSolveState, test = mNetwork] {
+            solveInBackground(test, *state);
+        });
+        mTimer.start();
+
+        requestRepaint();
+    }
 
-        solveOptimally(mNetwork, mSelected);
+    void DisasterGUI::finishSolve() {
+        mTimer.stop();
+        mWorker.join();
+        mSolveState.reset();
 
         /* Enable controls. */
         mSolve->setEnabled(true);
         mProblems->setEnabled(true);
-
-        requestRepaint();
+        mCancel->setEnabled(false);
     }
 }
 
@@ -428,6 +553,43 @@ namespace {
         }
     }
 
+    /* Backends the console demo can solve with. */
+    const vector<Disaster::SolverBackend> kDemoBackends = {
+        Disaster::SolverBackend::BRANCH_AND_BOUND,
+        Disaster::SolverBackend::SAT,
+        Disaster::SolverBackend::MEASURE_AND_CONQUER,
+        Disaster::SolverBackend::PORTFOLIO,
+        Disaster::SolverBackend::BUDGET_PROBES
+    };
+
+    /* Asks which backend to solve with. */
+    Disaster::SolverBackend chooseBackend() {
+        vector<string> names;
+        for (auto backend: kDemoBackends) {
+            names.push_back(Disaster::backendName(backend));
+        }
+        return kDemoBackends[makeSelectionFrom("Which solver should we use?", names)];
+    }
+
+    /* Displays which backends won this map's portfolio races. */
+    void displayPortfolioWins(const Disaster::SolverStats& stats) {
+        if (stats.portfolioWins.empty()) {
+            cout << "Every part of this map was simple enough to solve without a race." << endl;
+            return;
+        }
+
+        cout << "Portfolio races won on this map:" << endl;
+        for (const auto& win: stats.portfolioWins) {
+            cout << "  " << win.first << ": " << pluralize(win.second, "race", "races") << endl;
+        }
+    }
+
+    /* Displays how many budgets the probes decided on this map. */
+    void displayBudgetProbes(const Disaster::SolverStats& stats) {
+        cout << "Probed " << pluralize(stats.budgetProbes, "budget", "budgets") << ", "
+             << stats.settledProbes << " of them cancelled once other probes settled them." << endl;
+    }
+
     /* Displays the cities used in an optimal solution. */
     void displayBestCities(const Set<string>& cities) {
         cout << "You need to stockpile in " << pluralize(cities.size(), "city", "cities") << " to provide coverage." << endl;
@@ -445,13 +607,20 @@ namespace {
             auto scenario = loadDisaster(input);
 
             displayMap(scenario.network);
+            auto backend = chooseBackend();
 
             cout << "Running your code to find the fewest number of cities needed... " << flush;
             Set<string> cities;
-            solveOptimally(scenario, cities);
+            Disaster::SolverStats stats;
+            solveOptimally(scenario, backend, cities, stats);
             cout << "done!" << endl;
 
             displayBestCities(cities);
+            if (backend == Disaster::SolverBackend::PORTFOLIO) {
+                displayPortfolioWins(stats);
+            } else if (backend == Disaster::SolverBackend::BUDGET_PROBES) {
+                displayBudgetProbes(stats);
+            }
         } while (getYesOrNo("Try another demo file? "));
     }
 }
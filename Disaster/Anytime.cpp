@@ -0,0 +1,243 @@
+#include "Anytime.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* A cover being improved in place. For each city we track how many cover
+         * cities are in its closed neighborhood, so checking whether a cover city can
+         * go only looks at its own neighborhood.
+         */
+        class LocalSearch {
+        public:
+            LocalSearch(const CoverProblem& problem, unsigned seed)
+                : mProblem(problem),
+                  mClosed(closedNeighborhoods(problem.graph)),
+                  mCount(problem.graph.numCities(), 0),
+                  mInCover(problem.graph.numCities(), false),
+                  mStamp(problem.graph.numCities(), 0),
+                  mRandom(seed) {
+            }
+
+            const vector<CityId>& members() const {
+                return mMembers;
+            }
+
+            void assign(const vector<CityId>& cover) {
+                for (CityId city: vector<CityId>(mMembers)) remove(city);
+                for (CityId city: cover) add(city);
+            }
+
+            /* Removes cover cities whose neighborhoods are covered twice over. */
+            void dropRedundant() {
+                for (size_t i = 0; i < mMembers.size(); ) {
+                    if (isRedundant(mMembers[i])) {
+                        remove(mMembers[i]);
+                    } else {
+                        i++;
+                    }
+                }
+            }
+
+            /* Looks for a city whose addition lets two cover cities go. Makes the first
+             * such swap it finds, trying candidates in random order.
+             */
+            bool twoForOne() {
+                vector<CityId> candidates;
+                mProblem.allowed.forEach([&](CityId city) {
+                    if (!mInCover[city]) candidates.push_back(city);
+                });
+                shuffle(candidates.begin(), candidates.end(), mRandom);
+
+                for (CityId city: candidates) {
+                    add(city);
+
+                    /* Only cover cities within two roads of the new one can have lost
+                     * every city they alone covered.
+                     */
+                    vector<CityId> redundant;
+                    mGeneration++;
+                    for (CityId near: mProblem.graph.neighbors(city)) visitRedundant(near, city, redundant);
+                    visitRedundant(city, city, redundant);
+
+                    for (size_t i = 0; i < redundant.size(); i++) {
+                        for (size_t j = i + 1; j < redundant.size(); j++) {
+                            if (canDropBoth(redundant[i], redundant[j])) {
+                                remove(redundant[i]);
+                                remove(redundant[j]);
+                                return true;
+                            }
+                        }
+                    }
+                    remove(city);
+                }
+                return false;
+            }
+
+            /* Removes a random cover city and covers what it leaves uncovered with
+             * other cities, so the search moves to a different cover of about the
+             * same size.
+             */
+            void perturb() {
+                if (mMembers.empty()) return;
+                CityId out = mMembers[uniform_int_distribution<size_t>(0, mMembers.size() - 1)(mRandom)];
+                remove(out);
+
+                CityBitset uncovered(mProblem.graph.numCities());
+                mProblem.mustCover.forEach([&](CityId city) {
+                    if (mCount[city] == 0) uncovered.set(city);
+                });
+
+                /* Prefer not to put the same city straight back. */
+                CityBitset allowed = mProblem.allowed;
+                allowed.reset(out);
+                vector<CityId> added;
+                if (!greedyExtendCover(mClosed, allowed, uncovered, added)) {
+                    greedyExtendCover(mClosed, mProblem.allowed, uncovered, added);
+                }
+                for (CityId city: added) add(city);
+            }
+
+        private:
+            const CoverProblem& mProblem;
+            const vector<CityBitset> mClosed;
+            vector<int> mCount;         // Cover cities in the closed neighborhood of each city
+            vector<char> mInCover;
+            vector<CityId> mMembers;
+            vector<int> mStamp;         // Marks cities already visited by twoForOne
+            int mGeneration = 0;
+            mt19937 mRandom;
+
+            void add(CityId city) {
+                mInCover[city] = true;
+                mMembers.push_back(city);
+                for (CityId near: mProblem.graph.neighbors(city)) mCount[near]++;
+                mCount[city]++;
+            }
+
+            void remove(CityId city) {
+                mInCover[city] = false;
+                mMembers.erase(find(mMembers.begin(), mMembers.end(), city));
+                for (CityId near: mProblem.graph.neighbors(city)) mCount[near]--;
+                mCount[city]--;
+            }
+
+            /* Whether every city the given one covers is covered by something else too. */
+            bool isRedundant(CityId city) const {
+                if (mCount[city] == 1 && mProblem.mustCover.test(city)) return false;
+                for (CityId near: mProblem.graph.neighbors(city)) {
+                    if (mCount[near] == 1 && mProblem.mustCover.test(near)) return false;
+                }
+                return true;
+            }
+
+            /* Collects redundant cover cities in the closed neighborhood of center. */
+            void visitRedundant(CityId center, CityId added, vector<CityId>& redundant) {
+                auto visit = [&](CityId city) {
+                    if (mStamp[city] == mGeneration) return;
+                    mStamp[city] = mGeneration;
+                    if (city != added && mInCover[city] && isRedundant(city)) redundant.push_back(city);
+                };
+                visit(center);
+                for (CityId near: mProblem.graph.neighbors(center)) visit(near);
+            }
+
+            /* Two redundant cities can both go unless some city needing coverage is
+             * covered only by the two of them.
+             */
+            bool canDropBoth(CityId first, CityId second) const {
+                bool ok = true;
+                mClosed[first].forEach([&](CityId city) {
+                    if (ok && mClosed[second].test(city) && mCount[city] <= 2 && mProblem.mustCover.test(city)) {
+                        ok = false;
+                    }
+                });
+                return ok;
+            }
+        };
+    }
+
+    bool anytimeSupplyCover(const CoverProblem& problem, vector<CityId>& cover,
+                            const AnytimeOptions& options, const CoverCallback& onImprovement) {
+        auto deadline = chrono::steady_clock::now() +
+                        chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(options.seconds));
+        auto timeUp = [&] {
+            return chrono::steady_clock::now() >= deadline ||
+                   (options.cancel && options.cancel->load(memory_order_relaxed));
+        };
+
+        if (!greedySupplyCover(problem, cover)) return false;
+
+        LocalSearch search(problem, options.seed);
+        search.assign(cover);
+        search.dropRedundant();
+
+        vector<CityId> best = search.members();
+        auto report = [&] {
+            best = search.members();
+            if (onImprovement) {
+                vector<CityId> sorted = best;
+                sort(sorted.begin(), sorted.end());
+                onImprovement(sorted);
+            }
+        };
+        report();
+
+        /* Nothing can beat the lower bound, so there's no point trying. */
+        int bound = lowerBoundOnCover(problem);
+        while (int(best.size()) > bound && !timeUp()) {
+            if (search.twoForOne()) {
+                search.dropRedundant();
+            } else {
+                /* Wandering too far uphill rarely pays off; start again from the best. */
+                if (search.members().size() > best.size() + 1) search.assign(best);
+                search.perturb();
+                search.dropRedundant();
+            }
+
+            if (search.members().size() < best.size()) report();
+        }
+
+        cover = best;
+        sort(cover.begin(), cover.end());
+        return true;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("anytimeSupplyCover improves on greedy and reports each improvement.") {
+    using namespace Disaster;
+
+    /* Greedy takes the hub first and then needs both ends; two cities suffice. */
+    CoverProblem problem{RoadGraph({ "A", "B", "C", "D", "E", "F", "G" },
+                                   { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 5 },
+                                     { 0, 6 }, { 2, 6 }, { 3, 6 }, { 5, 6 } })};
+    std::vector<CityId> greedy;
+    EXPECT(greedySupplyCover(problem, greedy));
+
+    std::vector<size_t> sizes;
+    std::vector<CityId> cover;
+    AnytimeOptions options;
+    options.seconds = 0.1;
+    EXPECT(anytimeSupplyCover(problem, cover, options, [&](const std::vector<CityId>& improved) {
+        sizes.push_back(improved.size());
+    }));
+
+    std::vector<CityId> optimum;
+    EXPECT(findMinimumSupplyCover(problem, optimum));
+    EXPECT_EQUAL(cover.size(), optimum.size());
+    EXPECT_LESS_THAN_OR_EQUAL_TO(sizes.front(), greedy.size());
+    EXPECT_EQUAL(sizes.back(), cover.size());
+    for (size_t i = 1; i < sizes.size(); i++) {
+        EXPECT_LESS_THAN(sizes[i], sizes[i - 1]);
+    }
+
+    /* The result really is a cover. */
+    EXPECT(isValidCover(problem, cover));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace Disaster {
+    /* Called with each cover that's smaller than every cover reported before it. */
+    using CoverCallback = std::function<void(const std::vector<CityId>&)>;
+
+    /* Limits for the anytime heuristic. */
+    struct AnytimeOptions {
+        /* Wall-clock time to keep improving, in seconds. */
+        double seconds = 1.0;
+
+        /* If non-null, the search stops soon after this becomes true. */
+        const std::atomic<bool>* cancel = nullptr;
+
+        /* Seed for the random perturbations, so runs can be repeated. */
+        unsigned seed = 1;
+    };
+
+    /**
+     * Heuristic for instances too big to solve exactly. Starts from the greedy cover
+     * and improves it by local search until time runs out or the cover matches the
+     * lower bound, so it can be stopped at any point with a usable answer.
+     * <p>
+     * The local search drops cities that became redundant, looks for a city whose
+     * addition makes two others redundant (a 2-for-1 swap), and when stuck, removes a
+     * random city and greedily repairs the hole to move somewhere else on the plateau.
+     *
+     * @param problem       The instance to solve.
+     * @param cover         An outparameter filled in with the best cover found.
+     * @param options       Time budget, cancellation flag, and random seed.
+     * @param onImprovement If set, called with the first cover and every better one.
+     * @return Whether any cover exists.
+     */
+    bool anytimeSupplyCover(const CoverProblem& problem, std::vector<CityId>& cover,
+                            const AnytimeOptions& options = {}, const CoverCallback& onImprovement = {});
+}
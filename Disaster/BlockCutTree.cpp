@@ -0,0 +1,442 @@
+#include "BlockCutTree.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <string>
+using namespace std;
+
+namespace Disaster {
+    BlockCutTree blockCutTree(const RoadGraph& graph) {
+        int numCities = graph.numCities();
+        BlockCutTree result;
+        result.blocksOf.resize(numCities);
+
+        auto addBlock = [&](vector<CityId> block) {
+            sort(block.begin(), block.end());
+            for (CityId city: block) result.blocksOf[city].push_back(result.numBlocks());
+            result.blocks.push_back(std::move(block));
+        };
+
+        /* Depth-first search with an explicit stack, so long paths can't overflow the
+         * call stack. order is the discovery time and low the earliest discovery time
+         * reachable from a city's subtree through one back road. When a child's
+         * subtree can't reach above its parent, the parent cuts it off, and the cities
+         * visited since the child form a block with the parent.
+         */
+        struct Frame {
+            CityId city;
+            int parent;
+            int next;  // Index of the next neighbor to look at
+        };
+        vector<int> order(numCities, -1), low(numCities, 0);
+        vector<CityId> visited;
+        vector<Frame> frames;
+        int time = 0;
+
+        for (CityId root = 0; root < CityId(numCities); root++) {
+            if (order[root] != -1) continue;
+            order[root] = low[root] = time++;
+            if (graph.degree(root) == 0) {
+                addBlock({ root });
+                continue;
+            }
+
+            visited.assign(1, root);
+            frames.push_back({ root, -1, 0 });
+            while (!frames.empty()) {
+                CityId city = frames.back().city;
+                auto range = graph.neighbors(city);
+                if (frames.back().next < range.size()) {
+                    CityId next = range.begin()[frames.back().next++];
+                    if (order[next] == -1) {
+                        order[next] = low[next] = time++;
+                        visited.push_back(next);
+                        frames.push_back({ next, int(city), 0 });
+                    } else if (int(next) != frames.back().parent) {
+                        low[city] = min(low[city], order[next]);
+                    }
+                    continue;
+                }
+
+                int parent = frames.back().parent;
+                frames.pop_back();
+                if (parent == -1) continue;
+
+                low[parent] = min(low[parent], low[city]);
+                if (low[city] >= order[parent]) {
+                    vector<CityId> block = { CityId(parent) };
+                    CityId top;
+                    do {
+                        top = visited.back();
+                        visited.pop_back();
+                        block.push_back(top);
+                    } while (top != city);
+                    addBlock(std::move(block));
+                }
+            }
+        }
+        return result;
+    }
+
+    namespace {
+        /* Larger than any cover; sums of these stay well clear of overflow. */
+        const int kInfeasible = INT_MAX / 4;
+
+        int plus(int lhs, int rhs) {
+            return min(kInfeasible, lhs + rhs);
+        }
+
+        /* How a block's parent articulation point fares in a subproblem. */
+        enum Case {
+            SUPPLIED,  // It holds supplies, paid for by the rest of the network
+            COVERED,   // It doesn't, and this side of the network must cover it
+            OPEN,      // It doesn't, and this side needn't cover it
+            NUM_CASES
+        };
+
+        /* The cheapest cover of a block and everything below it, in one case. */
+        struct Outcome {
+            int cost = kInfeasible;  // Supplies in the block and below
+            vector<CityId> chosen;   // The block's own cities that hold supplies
+        };
+
+        /* The three costs of everything hanging below an articulation point, not
+         * counting the point itself.
+         */
+        struct Summary {
+            int supplied = 0, covered = kInfeasible, open = 0;
+            int coveringBlock = -1;  // The child block that covers it, in the COVERED case
+        };
+
+        class BlockCutSolver {
+        public:
+            BlockCutSolver(const CoverProblem& problem, const BlockCutTree& tree, const BlockSolver& solveBlock)
+                : mProblem(problem),
+                  mTree(tree),
+                  mSolveBlock(solveBlock),
+                  mParentCity(tree.numBlocks(), -1),
+                  mChildCities(tree.numBlocks()),
+                  mChildBlocks(problem.graph.numCities()),
+                  mSummaries(problem.graph.numCities()),
+                  mOutcomes(tree.numBlocks()),
+                  mLocal(problem.graph.numCities(), -1) {
+                root();
+            }
+
+            bool solve(vector<CityId>& cover) {
+                /* Children come after their parents in mOrder. */
+                for (int i = int(mOrder.size()) - 1; i >= 0; i--) {
+                    int block = mOrder[i];
+                    for (CityId city: mChildCities[block]) summarize(city);
+
+                    if (mParentCity[block] == -1) {
+                        if (!solveCase(block, OPEN)) return false;
+                        if (mOutcomes[block][OPEN].cost >= kInfeasible) return false;
+                    } else {
+                        for (Case which: { SUPPLIED, COVERED, OPEN }) {
+                            if (!solveCase(block, which)) return false;
+                        }
+                    }
+                }
+
+                assemble(cover);
+                return true;
+            }
+
+        private:
+            const CoverProblem& mProblem;
+            const BlockCutTree& mTree;
+            const BlockSolver& mSolveBlock;
+
+            vector<int> mOrder;                        // Blocks, parents before children
+            vector<int> mParentCity;                   // Per block; -1 for roots
+            vector<vector<CityId>> mChildCities;       // Per block: articulation points below
+            vector<vector<int>> mChildBlocks;          // Per city: blocks hanging below it
+            vector<Summary> mSummaries;                // Per articulation point
+            vector<array<Outcome, NUM_CASES>> mOutcomes;
+            vector<int> mLocal;                        // Scratch: city id within a block
+
+            /* Roots each tree of the forest at its largest block and orders the blocks.
+             * Every other block gets solved three times, so the root should be the one
+             * that costs the most to solve.
+             */
+            void root() {
+                vector<int> bySize(mTree.numBlocks());
+                for (int block = 0; block < mTree.numBlocks(); block++) bySize[block] = block;
+                stable_sort(bySize.begin(), bySize.end(), [&](int lhs, int rhs) {
+                    return mTree.blocks[lhs].size() > mTree.blocks[rhs].size();
+                });
+
+                vector<char> placed(mTree.numBlocks(), false);
+                for (int start: bySize) {
+                    if (placed[start]) continue;
+                    placed[start] = true;
+                    mOrder.push_back(start);
+
+                    for (size_t next = mOrder.size() - 1; next < mOrder.size(); next++) {
+                        int block = mOrder[next];
+                        for (CityId city: mTree.blocks[block]) {
+                            if (int(city) == mParentCity[block] || !mTree.isArticulation(city)) continue;
+
+                            mChildCities[block].push_back(city);
+                            for (int child: mTree.blocksOf[city]) {
+                                if (placed[child]) continue;
+                                placed[child] = true;
+                                mParentCity[child] = int(city);
+                                mChildBlocks[city].push_back(child);
+                                mOrder.push_back(child);
+                            }
+                        }
+                    }
+                }
+            }
+
+            /* Combines the outcomes of the blocks hanging below an articulation point.
+             * To be covered from below, one of them has to do the covering.
+             */
+            void summarize(CityId city) {
+                Summary& summary = mSummaries[city];
+                summary = Summary();
+                for (int child: mChildBlocks[city]) {
+                    summary.supplied = plus(summary.supplied, mOutcomes[child][SUPPLIED].cost);
+                    summary.open     = plus(summary.open,     mOutcomes[child][OPEN].cost);
+                }
+                for (int child: mChildBlocks[city]) {
+                    int rest = summary.open - mOutcomes[child][OPEN].cost;
+                    int cost = plus(mOutcomes[child][COVERED].cost, rest);
+                    if (summary.open < kInfeasible && cost < summary.covered) {
+                        summary.covered = cost;
+                        summary.coveringBlock = child;
+                    }
+                }
+            }
+
+            /* Builds the block's subproblem for the given case, with a gadget for each
+             * subtree below it, and solves it. Returns false only if the block solver
+             * gave up; an infeasible case just gets an infinite cost.
+             *
+             * Let P, C, and N be a subtree's costs when its articulation point c is
+             * supplied, covered from below, or open. Supplying c never makes the subtree
+             * dearer, and one more supply next to c turns an open cover into one that
+             * covers c, so P <= N <= C <= N + 1 (or C is infinite). Supplying c costs
+             * P + 1 in all, so either that's the cheapest option and c might as well
+             * hold supplies, or P = N. In the first case, a pendant city that can't
+             * hold supplies forces supplies onto c. Otherwise the subtree costs N plus:
+             * nothing more if C = N, so c needn't be covered; or 1 to cover c from
+             * below, which is what a pendant city that can hold supplies costs. If c
+             * can hold supplies itself, that pendant is never better than c.
+             */
+            bool solveCase(int block, Case which) {
+                Outcome& outcome = mOutcomes[block][which];
+                outcome = Outcome();
+
+                int parent = mParentCity[block];
+                vector<CityId> cities;
+                for (CityId city: mTree.blocks[block]) {
+                    if (int(city) != parent || which == COVERED) cities.push_back(city);
+                }
+                for (size_t i = 0; i < cities.size(); i++) mLocal[cities[i]] = int(i);
+
+                vector<pair<CityId, CityId>> roads;
+                for (CityId city: cities) {
+                    for (CityId near: mProblem.graph.neighbors(city)) {
+                        if (mLocal[near] != -1 && city < near) roads.emplace_back(CityId(mLocal[city]), CityId(mLocal[near]));
+                    }
+                }
+
+                vector<char> mustCover(cities.size()), allowed(cities.size());
+                for (size_t i = 0; i < cities.size(); i++) {
+                    mustCover[i] = mProblem.mustCover.test(cities[i]);
+                    allowed[i]   = mProblem.allowed.test(cities[i]);
+                }
+                if (which == SUPPLIED) {
+                    for (CityId near: mProblem.graph.neighbors(CityId(parent))) {
+                        if (mLocal[near] != -1) mustCover[mLocal[near]] = false;
+                    }
+                } else if (which == COVERED) {
+                    mustCover[mLocal[parent]] = true;
+                    allowed[mLocal[parent]] = false;
+                }
+
+                /* Gadgets for the subtrees below. */
+                int offset = 0;
+                for (CityId city: mChildCities[block]) {
+                    const Summary& summary = mSummaries[city];
+                    int local = mLocal[city];
+                    int supply = allowed[local]? plus(summary.supplied, 1) : kInfeasible;
+                    int covered = mustCover[local]? summary.covered : summary.open;
+
+                    if (supply >= kInfeasible && summary.open >= kInfeasible) {
+                        offset = kInfeasible;
+                    } else if (supply <= summary.open) {
+                        roads.emplace_back(CityId(local), CityId(mustCover.size()));
+                        mustCover.push_back(true);
+                        allowed.push_back(false);
+                        offset = plus(offset, summary.supplied);
+                    } else {
+                        offset = plus(offset, summary.open);
+                        if (covered == summary.open) {
+                            mustCover[local] = false;
+                        } else if (covered == plus(summary.open, 1) && !allowed[local]) {
+                            roads.emplace_back(CityId(local), CityId(mustCover.size()));
+                            mustCover.push_back(false);
+                            allowed.push_back(true);
+                        }
+                    }
+                }
+
+                bool finished = true;
+                if (offset < kInfeasible) {
+                    vector<string> names;
+                    for (size_t i = 0; i < mustCover.size(); i++) names.push_back(to_string(i));
+                    CoverProblem subproblem{RoadGraph(names, roads)};
+                    for (size_t i = 0; i < mustCover.size(); i++) {
+                        if (!mustCover[i]) subproblem.mustCover.reset(CityId(i));
+                        if (!allowed[i])   subproblem.allowed.reset(CityId(i));
+                    }
+
+                    vector<CityId> cover;
+                    if (mSolveBlock(subproblem, cover)) {
+                        outcome.cost = plus(offset, int(cover.size()));
+                        for (CityId city: cover) {
+                            if (city < cities.size()) outcome.chosen.push_back(cities[city]);
+                        }
+                    } else {
+                        finished = !hasCover(subproblem);
+                    }
+                }
+
+                for (CityId city: cities) mLocal[city] = -1;
+                return finished;
+            }
+
+            /* Whether some cover exists, which tells a block solver that found none
+             * apart from one that gave up.
+             */
+            static bool hasCover(const CoverProblem& problem) {
+                vector<CityId> cover;
+                return greedySupplyCover(problem, cover);
+            }
+
+            /* Reads off the cover from the root down. Each block's outcome in its case
+             * says which case each articulation point below it is in.
+             */
+            void assemble(vector<CityId>& cover) {
+                cover.clear();
+                vector<pair<int, Case>> pending;
+                for (int block: mOrder) {
+                    if (mParentCity[block] == -1) pending.emplace_back(block, OPEN);
+                }
+
+                vector<char> supplied(mProblem.graph.numCities(), false);
+                while (!pending.empty()) {
+                    auto [block, which] = pending.back();
+                    pending.pop_back();
+
+                    const Outcome& outcome = mOutcomes[block][which];
+                    for (CityId city: outcome.chosen) {
+                        cover.push_back(city);
+                        supplied[city] = true;
+                    }
+
+                    int parent = mParentCity[block];
+                    for (CityId city: mChildCities[block]) {
+                        Case below;
+                        if (supplied[city]) {
+                            below = SUPPLIED;
+                        } else if (!mProblem.mustCover.test(city) ||
+                                   (which == SUPPLIED && mProblem.graph.isAdjacent(city, CityId(parent))) ||
+                                   coveredWithin(block, city, supplied)) {
+                            below = OPEN;
+                        } else {
+                            below = COVERED;
+                        }
+
+                        for (int child: mChildBlocks[city]) {
+                            bool covering = below == COVERED && child == mSummaries[city].coveringBlock;
+                            pending.emplace_back(child, below == COVERED && !covering? OPEN : below);
+                        }
+                    }
+
+                    for (CityId city: outcome.chosen) supplied[city] = false;
+                }
+                sort(cover.begin(), cover.end());
+            }
+
+            /* Whether a neighbor of the city in the same block holds supplies. */
+            bool coveredWithin(int block, CityId city, const vector<char>& supplied) const {
+                for (CityId near: mProblem.graph.neighbors(city)) {
+                    if (supplied[near] && binary_search(mTree.blocks[block].begin(), mTree.blocks[block].end(), near)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+    }
+
+    bool blockCutSupplyCover(const CoverProblem& problem, const BlockCutTree& tree,
+                             vector<CityId>& cover, const BlockSolver& solveBlock) {
+        return BlockCutSolver(problem, tree, solveBlock).solve(cover);
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("blockCutTree splits a bowtie at its middle city.") {
+    using namespace Disaster;
+
+    /* Two triangles sharing C, a road from E to F, and a city G with no roads. */
+    RoadGraph graph({ "A", "B", "C", "D", "E", "F", "G" },
+                    { { 0, 1 }, { 1, 2 }, { 2, 0 }, { 2, 3 }, { 3, 4 }, { 4, 2 }, { 4, 5 } });
+    BlockCutTree tree = blockCutTree(graph);
+    EXPECT_EQUAL(tree.numBlocks(), 4);
+
+    std::vector<std::vector<CityId>> blocks = tree.blocks;
+    std::sort(blocks.begin(), blocks.end());
+    EXPECT(blocks == std::vector<std::vector<CityId>>({ { 0, 1, 2 }, { 2, 3, 4 }, { 4, 5 }, { 6 } }));
+
+    EXPECT(tree.isArticulation(2));
+    EXPECT(tree.isArticulation(4));
+    EXPECT(!tree.isArticulation(0));
+    EXPECT(!tree.isArticulation(6));
+}
+
+STUDENT_TEST("blockCutSupplyCover agrees with branch and bound on random networks with cut cities.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(314);
+    for (int trial = 0; trial < 200; trial++) {
+        int numCities = 1 + trial % 35;
+        std::vector<std::string> names;
+        for (int i = 0; i < numCities; i++) names.push_back(std::to_string(i));
+
+        /* A random tree with a few extra roads, so most blocks are small cycles. */
+        std::vector<std::pair<CityId, CityId>> roads;
+        for (int i = 1; i < numCities; i++) {
+            roads.emplace_back(CityId(i), CityId(generator() % i));
+        }
+        for (int i = 0; i < numCities / 3; i++) {
+            CityId city = CityId(generator() % numCities);
+            CityId near = CityId(max(0, int(city) - 1 - int(generator() % 3)));
+            roads.emplace_back(city, near);
+        }
+        CoverProblem problem{RoadGraph(names, roads)};
+
+        if (trial % 3 == 0) restrictRandomly(generator, problem);
+
+        std::vector<CityId> expected, cover;
+        bool feasible = findMinimumSupplyCover(problem, expected);
+        BlockCutTree tree = blockCutTree(problem.graph);
+        EXPECT_EQUAL(blockCutSupplyCover(problem, tree, cover, [](const CoverProblem& block, std::vector<CityId>& blockCover) {
+            return findMinimumSupplyCover(block, blockCover);
+        }), feasible);
+        if (!feasible) continue;
+        EXPECT_EQUAL(cover.size(), expected.size());
+
+        EXPECT(isValidCover(problem, cover));
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "RoadGraph.h"
+#include "SupplySearch.h"
+#include <functional>
+#include <vector>
+
+namespace Disaster {
+    /**
+     * The biconnected blocks of a road network. Two blocks share at most one city, an
+     * articulation point whose removal disconnects them. Joining each block to its
+     * articulation points gives a forest, the block-cut tree. Every road belongs to
+     * exactly one block, and a city with no roads is a block by itself.
+     */
+    struct BlockCutTree {
+        std::vector<std::vector<CityId>> blocks;  // Cities in each block, sorted
+        std::vector<std::vector<int>> blocksOf;   // Blocks containing each city
+
+        int numBlocks() const {
+            return int(blocks.size());
+        }
+
+        bool isArticulation(CityId city) const {
+            return blocksOf[city].size() > 1;
+        }
+    };
+
+    /* Finds the blocks with Tarjan's algorithm, in time linear in the network's size. */
+    BlockCutTree blockCutTree(const RoadGraph& graph);
+
+    /* Finds a minimum cover of a subproblem, or returns false if there is none. */
+    using BlockSolver = std::function<bool(const CoverProblem& problem, std::vector<CityId>& cover)>;
+
+    /**
+     * Finds a minimum cover by dynamic programming over the block-cut tree, so the
+     * exponential work happens one block at a time.
+     * <p>
+     * Blocks are solved from the leaves of the tree up. Below each articulation point
+     * hangs a subtree, and all the rest of the network needs to know about it is the
+     * cheapest cover of the subtree in three cases: the articulation point holds
+     * supplies, it's covered from inside the subtree, or neither. The three costs
+     * always differ in a way a tiny gadget can mimic, so each block is solved as an
+     * ordinary subproblem with gadgets standing in for its subtrees, by whatever
+     * solver the caller provides. A last pass from the root down reads off which case
+     * each articulation point ended up in.
+     *
+     * @param problem    The instance to solve.
+     * @param tree       The block-cut tree of the instance's road network.
+     * @param cover      An outparameter filled in with a minimum-size cover.
+     * @param solveBlock Finds minimum covers of the blocks.
+     * @return Whether any cover exists. Also false if solveBlock ever returns false.
+     */
+    bool blockCutSupplyCover(const CoverProblem& problem, const BlockCutTree& tree,
+                             std::vector<CityId>& cover, const BlockSolver& solveBlock);
+}
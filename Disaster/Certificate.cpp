@@ -0,0 +1,207 @@
+#include "Certificate.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* Each round of multiplicative weights raises a supplier's price by this factor. */
+        const double kPriceStep = 1.1;
+
+        /* Rounds of multiplicative weights per city that must be covered. */
+        const int kRoundsPerCity = 40;
+
+        /* Slack for floating-point error when totaling fractional weights. */
+        const double kTolerance = 1e-9;
+
+        /* Allowed cities that could cover the given city. */
+        CityBitset suppliersOf(const CoverProblem& problem, const vector<CityBitset>& closed, CityId city) {
+            CityBitset result = closed[city];
+            result &= problem.allowed;
+            return result;
+        }
+
+        /* The bound fractional weights prove, given the heaviest load on any supplier.
+         * Loads over 1 scale the whole solution down.
+         */
+        int fractionalBound(double total, double maxLoad) {
+            return int(ceil(total / max(1.0, maxLoad) - kTolerance * (1 + total)));
+        }
+
+        /* The largest total weight in the closed neighborhood of an allowed city. */
+        double maxLoad(const CoverProblem& problem, const vector<double>& weights) {
+            double result = 0;
+            problem.allowed.forEach([&](CityId city) {
+                double load = problem.mustCover.test(city)? weights[city] : 0;
+                for (CityId near: problem.graph.neighbors(city)) {
+                    if (problem.mustCover.test(near)) load += weights[near];
+                }
+                result = max(result, load);
+            });
+            return result;
+        }
+    }
+
+    CoverCertificate packingCertificate(const CoverProblem& problem) {
+        auto closed = closedNeighborhoods(problem.graph);
+
+        vector<CityId> order;
+        vector<int> choices(problem.graph.numCities());
+        problem.mustCover.forEach([&](CityId city) {
+            order.push_back(city);
+            choices[city] = closed[city].countAnd(problem.allowed);
+        });
+        stable_sort(order.begin(), order.end(), [&](CityId lhs, CityId rhs) {
+            return choices[lhs] < choices[rhs];
+        });
+
+        CoverCertificate result;
+        result.kind = CertificateKind::PACKING;
+        CityBitset used(problem.graph.numCities());
+        for (CityId city: order) {
+            CityBitset suppliers = suppliersOf(problem, closed, city);
+            if (suppliers.intersects(used)) continue;
+
+            used |= suppliers;
+            result.packing.push_back(city);
+        }
+        sort(result.packing.begin(), result.packing.end());
+        result.bound = int(result.packing.size());
+        return result;
+    }
+
+    /* This is the Garg-Konemann scheme for packing LPs. Every supplier has a price,
+     * initially 1. Each round adds one unit of weight to the city whose suppliers are
+     * cheapest in total, then makes those suppliers pricier. Weight piles up on cities
+     * whose suppliers are rarely shared, which is what the optimum does too. The loads
+     * overshoot 1, so the weights get scaled down at the end.
+     */
+    CoverCertificate fractionalCertificate(const CoverProblem& problem) {
+        int numCities = problem.graph.numCities();
+        auto closed = closedNeighborhoods(problem.graph);
+
+        /* Cities that can't be covered at all say nothing about cover sizes. */
+        vector<CityId> targets;
+        vector<vector<CityId>> suppliers(numCities);
+        problem.mustCover.forEach([&](CityId city) {
+            suppliersOf(problem, closed, city).forEach([&](CityId supplier) {
+                suppliers[city].push_back(supplier);
+            });
+            if (!suppliers[city].empty()) targets.push_back(city);
+        });
+
+        CoverCertificate result;
+        result.kind = CertificateKind::FRACTIONAL;
+        result.weights.assign(numCities, 0);
+        if (targets.empty()) return result;
+
+        vector<double> price(numCities, 1);
+        int rounds = kRoundsPerCity * int(targets.size());
+        for (int round = 0; round < rounds; round++) {
+            CityId cheapest = targets[0];
+            double cheapestCost = HUGE_VAL;
+            for (CityId city: targets) {
+                double cost = 0;
+                for (CityId supplier: suppliers[city]) cost += price[supplier];
+                if (cost < cheapestCost) {
+                    cheapest = city;
+                    cheapestCost = cost;
+                }
+            }
+
+            result.weights[cheapest] += 1;
+            for (CityId supplier: suppliers[cheapest]) {
+                price[supplier] *= kPriceStep;
+            }
+
+            /* Only ratios of prices matter; keep them in range. */
+            if (cheapestCost > 1e200) {
+                for (double& value: price) value *= 1e-200;
+            }
+        }
+
+        double load = maxLoad(problem, result.weights);
+        double total = 0;
+        for (double& weight: result.weights) {
+            weight /= load;
+            total += weight;
+        }
+        result.bound = fractionalBound(total, maxLoad(problem, result.weights));
+        return result;
+    }
+
+    CoverCertificate strongestCertificate(const CoverProblem& problem) {
+        CoverCertificate packing = packingCertificate(problem);
+        CoverCertificate fractional = fractionalCertificate(problem);
+        return fractional.bound > packing.bound? fractional : packing;
+    }
+
+    int checkCertificate(const CoverProblem& problem, const CoverCertificate& certificate) {
+        int numCities = problem.graph.numCities();
+        if (certificate.kind == CertificateKind::PACKING) {
+            auto closed = closedNeighborhoods(problem.graph);
+            CityBitset used(numCities);
+            for (CityId city: certificate.packing) {
+                if (city >= CityId(numCities) || !problem.mustCover.test(city)) return -1;
+
+                CityBitset suppliers = suppliersOf(problem, closed, city);
+                if (suppliers.intersects(used)) return -1;
+                used |= suppliers;
+            }
+            return int(certificate.packing.size());
+        }
+
+        if (int(certificate.weights.size()) != numCities) return -1;
+        double total = 0;
+        for (CityId city = 0; city < CityId(numCities); city++) {
+            double weight = certificate.weights[city];
+            if (!(weight >= 0) || (weight > 0 && !problem.mustCover.test(city))) return -1;
+            total += weight;
+        }
+        return fractionalBound(total, maxLoad(problem, certificate.weights));
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("Certificates prove valid lower bounds and survive an audit.") {
+    using namespace Disaster;
+
+    /* A 5-cycle needs 2 cities. No two closed neighborhoods are disjoint... */
+    CoverProblem cycle{RoadGraph({ "A", "B", "C", "D", "E" },
+                                 { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 0 } })};
+    CoverCertificate packing = packingCertificate(cycle);
+    EXPECT_EQUAL(packing.bound, 1);
+    EXPECT_EQUAL(checkCertificate(cycle, packing), 1);
+
+    /* ...but weight 1/3 on each city adds up to 5/3, which rounds up to 2. */
+    CoverCertificate fractional = fractionalCertificate(cycle);
+    EXPECT_EQUAL(fractional.bound, 2);
+    EXPECT_EQUAL(checkCertificate(cycle, fractional), 2);
+    EXPECT_EQUAL(strongestCertificate(cycle).bound, 2);
+
+    /* Tampering is caught. */
+    fractional.weights[0] = -1;
+    EXPECT_EQUAL(checkCertificate(cycle, fractional), -1);
+    packing.packing = { 0, 1 };
+    EXPECT_EQUAL(checkCertificate(cycle, packing), -1);
+
+    /* On a 6 x 6 grid (minimum 10) the bounds are valid and not far off. */
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int row = 0; row < 6; row++) {
+        for (int col = 0; col < 6; col++) {
+            CityId id = CityId(names.size());
+            names.push_back(std::to_string(row) + "," + std::to_string(col));
+            if (row > 0) roads.emplace_back(id, id - 6);
+            if (col > 0) roads.emplace_back(id, id - 1);
+        }
+    }
+    CoverProblem grid{RoadGraph(names, roads)};
+    CoverCertificate best = strongestCertificate(grid);
+    EXPECT_EQUAL(checkCertificate(grid, best), best.bound);
+    EXPECT_LESS_THAN_OR_EQUAL_TO(best.bound, 10);
+    EXPECT_GREATER_THAN_OR_EQUAL_TO(best.bound, lowerBoundOnCover(grid));
+}
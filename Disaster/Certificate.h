@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include <vector>
+
+namespace Disaster {
+    /* The two kinds of lower-bound certificate. */
+    enum class CertificateKind {
+        PACKING,     // Cities no two of which could be covered by the same supply
+        FRACTIONAL   // A feasible solution to the dual of the LP relaxation
+    };
+
+    /**
+     * Evidence that every cover needs at least bound cities, which anyone can check
+     * without searching; see checkCertificate.
+     * <p>
+     * A packing lists cities that must be covered such that no allowed city lies in
+     * the closed neighborhoods of two of them. Each needs its own supply.
+     * <p>
+     * Fractional weights put a nonnegative weight on each city that must be covered,
+     * such that the weights within the closed neighborhood of any allowed city add up
+     * to at most 1. A supply then covers at most 1 unit of weight, so a cover needs at
+     * least the total weight, rounded up. Packings are the special case of 0/1 weights.
+     */
+    struct CoverCertificate {
+        CertificateKind kind = CertificateKind::PACKING;
+        std::vector<CityId> packing;  // For PACKING
+        std::vector<double> weights;  // For FRACTIONAL: one weight per city
+        int bound = 0;                // Every cover needs at least this many cities
+    };
+
+    /* Greedily packs cities, those with the fewest possible suppliers first. */
+    CoverCertificate packingCertificate(const CoverProblem& problem);
+
+    /* Approximately solves the dual of the LP relaxation by multiplicative weights,
+     * then scales the result down until it's exactly feasible.
+     */
+    CoverCertificate fractionalCertificate(const CoverProblem& problem);
+
+    /* Whichever of the two certificates proves more. */
+    CoverCertificate strongestCertificate(const CoverProblem& problem);
+
+    /**
+     * Audits a certificate from scratch.
+     *
+     * @return The bound the certificate proves, or -1 if it isn't valid.
+     */
+    int checkCertificate(const CoverProblem& problem, const CoverCertificate& certificate);
+}
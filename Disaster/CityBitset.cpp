@@ -0,0 +1,187 @@
+#include "CityBitset.h"
+using namespace std;
+
+namespace Disaster {
+    void CityBitset::clear() {
+        for (auto& word: mWords) word = 0;
+    }
+
+    void CityBitset::setAll() {
+        for (auto& word: mWords) word = ~uint64_t(0);
+
+        /* Keep the bits past the end zero. */
+        if (mSize % 64 != 0) {
+            mWords.back() = (uint64_t(1) << (mSize % 64)) - 1;
+        }
+    }
+
+    int CityBitset::count() const {
+        int result = 0;
+        for (auto word: mWords) result += popcount64(word);
+        return result;
+    }
+
+    bool CityBitset::none() const {
+        for (auto word: mWords) {
+            if (word) return false;
+        }
+        return true;
+    }
+
+    bool CityBitset::isFull() const {
+        return count() == mSize;
+    }
+
+    int CityBitset::firstSet() const {
+        return nextSet(0);
+    }
+
+    int CityBitset::firstUnset() const {
+        for (int w = 0; w < numWords(); w++) {
+            uint64_t missing = ~mWords[w];
+            if (missing != 0) {
+                int result = w * 64 + lowestBit64(missing);
+                return result < mSize? result : -1;
+            }
+        }
+        return -1;
+    }
+
+    int CityBitset::nextSet(int from) const {
+        if (from >= mSize) return -1;
+
+        int w = from / 64;
+        uint64_t word = mWords[w] & (~uint64_t(0) << (from % 64));
+        while (true) {
+            if (word != 0) return w * 64 + lowestBit64(word);
+            if (++w == numWords()) return -1;
+            word = mWords[w];
+        }
+    }
+
+    CityBitset& CityBitset::operator|= (const CityBitset& rhs) {
+        assignOr(*this, rhs);
+        return *this;
+    }
+
+    CityBitset& CityBitset::operator&= (const CityBitset& rhs) {
+        for (int w = 0; w < numWords(); w++) {
+            mWords[w] &= rhs.mWords[w];
+        }
+        return *this;
+    }
+
+    CityBitset& CityBitset::andNot(const CityBitset& rhs) {
+        for (int w = 0; w < numWords(); w++) {
+            mWords[w] &= ~rhs.mWords[w];
+        }
+        return *this;
+    }
+
+    void CityBitset::assignOr(const CityBitset& lhs, const CityBitset& rhs) {
+        for (int w = 0; w < numWords(); w++) {
+            mWords[w] = lhs.mWords[w] | rhs.mWords[w];
+        }
+    }
+
+    bool CityBitset::isSubsetOf(const CityBitset& rhs) const {
+        for (int w = 0; w < numWords(); w++) {
+            if (mWords[w] & ~rhs.mWords[w]) return false;
+        }
+        return true;
+    }
+
+    bool CityBitset::isSubsetOf(const CityBitset& rhs, const CityBitset& except) const {
+        for (int w = 0; w < numWords(); w++) {
+            if (mWords[w] & ~rhs.mWords[w] & ~except.mWords[w]) return false;
+        }
+        return true;
+    }
+
+    bool CityBitset::intersects(const CityBitset& rhs) const {
+        for (int w = 0; w < numWords(); w++) {
+            if (mWords[w] & rhs.mWords[w]) return true;
+        }
+        return false;
+    }
+
+    int CityBitset::countAnd(const CityBitset& rhs) const {
+        int result = 0;
+        for (int w = 0; w < numWords(); w++) {
+            result += popcount64(mWords[w] & rhs.mWords[w]);
+        }
+        return result;
+    }
+
+    int CityBitset::countAndNot(const CityBitset& rhs) const {
+        int result = 0;
+        for (int w = 0; w < numWords(); w++) {
+            result += popcount64(mWords[w] & ~rhs.mWords[w]);
+        }
+        return result;
+    }
+
+    vector<CityId> CityBitset::toVector() const {
+        vector<CityId> result;
+        forEach([&](CityId city) {
+            result.push_back(city);
+        });
+        return result;
+    }
+
+    vector<CityBitset> closedNeighborhoods(const RoadGraph& graph) {
+        vector<CityBitset> result(graph.numCities(), CityBitset(graph.numCities()));
+        for (CityId city = 0; city < CityId(graph.numCities()); city++) {
+            result[city].set(city);
+            for (CityId neighbor: graph.neighbors(city)) {
+                result[city].set(neighbor);
+            }
+        }
+        return result;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("CityBitset handles sets spanning several words.") {
+    using Disaster::CityBitset;
+
+    CityBitset lhs(300), rhs(300);
+    EXPECT(lhs.none());
+    EXPECT_EQUAL(lhs.firstUnset(), 0);
+
+    lhs.set(3);
+    lhs.set(64);
+    lhs.set(299);
+    rhs.set(64);
+    EXPECT_EQUAL(lhs.count(), 3);
+    EXPECT(rhs.isSubsetOf(lhs));
+    EXPECT(!lhs.isSubsetOf(rhs));
+    EXPECT(lhs.isSubsetOf(rhs, lhs));
+    EXPECT(lhs.intersects(rhs));
+    EXPECT_EQUAL(lhs.nextSet(65), 299);
+
+    lhs.andNot(rhs);
+    EXPECT(lhs.toVector() == std::vector<Disaster::CityId>({ 3, 299 }));
+
+    CityBitset both(300);
+    both.assignOr(lhs, rhs);
+    EXPECT_EQUAL(both.count(), 3);
+
+    both.setAll();
+    EXPECT(both.isFull());
+    EXPECT_EQUAL(both.count(), 300);
+    EXPECT_EQUAL(both.firstUnset(), -1);
+    EXPECT_EQUAL(both.countAndNot(lhs), 298);
+}
+
+STUDENT_TEST("closedNeighborhoods includes each city and its neighbors.") {
+    Disaster::RoadGraph graph({ "A", "B", "C" }, { { 0, 1 } });
+    auto masks = Disaster::closedNeighborhoods(graph);
+
+    EXPECT(masks[0].toVector() == std::vector<Disaster::CityId>({ 0, 1 }));
+    EXPECT(masks[1].toVector() == std::vector<Disaster::CityId>({ 0, 1 }));
+    EXPECT(masks[2].toVector() == std::vector<Disaster::CityId>({ 2 }));
+}
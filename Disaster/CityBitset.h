@@ -0,0 +1,138 @@
+#pragma once
+
+#include "RoadGraph.h"
+#include <cstdint>
+#include <vector>
+
+namespace Disaster {
+    /* Number of set bits in a 64-bit word. */
+    inline int popcount64(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(word);
+#else
+        int result = 0;
+        for (; word != 0; word &= word - 1) result++;
+        return result;
+#endif
+    }
+
+    /* Index of the lowest set bit in a nonzero 64-bit word. */
+    inline int lowestBit64(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word);
+#else
+        int result = 0;
+        while (!(word & 1)) { word >>= 1; result++; }
+        return result;
+#endif
+    }
+
+    /**
+     * A fixed-size set of city ids stored as packed 64-bit words. Bits past the end
+     * of the set are always zero, so whole-word operations never need masking.
+     */
+    class CityBitset {
+    public:
+        CityBitset() = default;
+
+        /* Creates an empty set able to hold ids in [0, size). */
+        explicit CityBitset(int size)
+            : mWords((size + 63) / 64, 0), mSize(size) {
+        }
+
+        int size() const {
+            return mSize;
+        }
+        int numWords() const {
+            return int(mWords.size());
+        }
+        const std::uint64_t* words() const {
+            return mWords.data();
+        }
+        std::uint64_t* words() {
+            return mWords.data();
+        }
+
+        bool test(CityId city) const {
+            return (mWords[city >> 6] >> (city & 63)) & 1;
+        }
+        void set(CityId city) {
+            mWords[city >> 6] |= std::uint64_t(1) << (city & 63);
+        }
+        void reset(CityId city) {
+            mWords[city >> 6] &= ~(std::uint64_t(1) << (city & 63));
+        }
+
+        /* Empties the set. */
+        void clear();
+
+        /* Adds every id in [0, size()). */
+        void setAll();
+
+        int count() const;
+        bool none() const;
+        bool any() const {
+            return !none();
+        }
+
+        /* Whether every id in [0, size()) is present. */
+        bool isFull() const;
+
+        /* Lowest id in the set, or -1 if the set is empty. */
+        int firstSet() const;
+
+        /* Lowest id in [0, size()) not in the set, or -1 if the set is full. */
+        int firstUnset() const;
+
+        /* Lowest id >= from in the set, or -1 if there isn't one. */
+        int nextSet(int from) const;
+
+        /* Calls fn(id) for each id in the set, in increasing order. */
+        template <typename Function> void forEach(Function fn) const {
+            for (int w = 0; w < numWords(); w++) {
+                for (std::uint64_t word = mWords[w]; word != 0; word &= word - 1) {
+                    fn(CityId(w * 64 + lowestBit64(word)));
+                }
+            }
+        }
+
+        CityBitset& operator|= (const CityBitset& rhs);
+        CityBitset& operator&= (const CityBitset& rhs);
+
+        /* Removes every element of rhs from this set. */
+        CityBitset& andNot(const CityBitset& rhs);
+
+        /* Sets this set to lhs | rhs without allocating. All three must be the same size. */
+        void assignOr(const CityBitset& lhs, const CityBitset& rhs);
+
+        bool isSubsetOf(const CityBitset& rhs) const;
+        bool intersects(const CityBitset& rhs) const;
+
+        /* Whether every element of this set that isn't in except is in rhs. */
+        bool isSubsetOf(const CityBitset& rhs, const CityBitset& except) const;
+
+        /* Size of the intersection / difference with another set, without building it. */
+        int countAnd(const CityBitset& rhs) const;
+        int countAndNot(const CityBitset& rhs) const;
+
+        bool operator== (const CityBitset& rhs) const {
+            return mSize == rhs.mSize && mWords == rhs.mWords;
+        }
+        bool operator!= (const CityBitset& rhs) const {
+            return !(*this == rhs);
+        }
+
+        /* Converts to a sorted list of ids. */
+        std::vector<CityId> toVector() const;
+
+    private:
+        std::vector<std::uint64_t> mWords;
+        int mSize = 0;
+    };
+
+    /**
+     * Precomputes the closed neighborhood N[c] = {c} ∪ neighbors(c) of every city as
+     * a bitset. Placing supplies in c covers exactly the cities in N[c].
+     */
+    std::vector<CityBitset> closedNeighborhoods(const RoadGraph& graph);
+}
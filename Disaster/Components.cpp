@@ -0,0 +1,70 @@
+#include "Components.h"
+#include <algorithm>
+using namespace std;
+
+namespace Disaster {
+    Subproblem restrictTo(const CoverProblem& problem, const vector<CityId>& cities) {
+        Subproblem result;
+        result.original = cities;
+        result.problem.graph = problem.graph.induced(cities);
+
+        int size = int(cities.size());
+        result.problem.mustCover = CityBitset(size);
+        result.problem.allowed   = CityBitset(size);
+        for (int i = 0; i < size; i++) {
+            if (problem.mustCover.test(cities[i])) result.problem.mustCover.set(CityId(i));
+            if (problem.allowed.test(cities[i]))   result.problem.allowed.set(CityId(i));
+        }
+        return result;
+    }
+
+    vector<Subproblem> connectedComponents(const CoverProblem& problem) {
+        const RoadGraph& graph = problem.graph;
+        vector<char> visited(graph.numCities(), false);
+        vector<Subproblem> result;
+
+        for (CityId start = 0; start < CityId(graph.numCities()); start++) {
+            if (visited[start]) continue;
+
+            /* Breadth-first search out from this city. */
+            vector<CityId> component = { start };
+            visited[start] = true;
+            for (size_t next = 0; next < component.size(); next++) {
+                for (CityId neighbor: graph.neighbors(component[next])) {
+                    if (!visited[neighbor]) {
+                        visited[neighbor] = true;
+                        component.push_back(neighbor);
+                    }
+                }
+            }
+
+            sort(component.begin(), component.end());
+            result.push_back(restrictTo(problem, component));
+        }
+        return result;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("connectedComponents splits islands and keeps annotations.") {
+    using namespace Disaster;
+
+    CoverProblem problem{RoadGraph({ "A", "B", "C", "D", "E" }, { { 0, 3 }, { 1, 4 } })};
+    problem.mustCover.reset(3);
+    problem.allowed.reset(4);
+
+    auto components = connectedComponents(problem);
+    EXPECT_EQUAL(components.size(), 3);
+
+    EXPECT(components[0].original == std::vector<CityId>({ 0, 3 }));
+    EXPECT(components[1].original == std::vector<CityId>({ 1, 4 }));
+    EXPECT(components[2].original == std::vector<CityId>({ 2 }));
+
+    EXPECT_EQUAL(components[0].problem.graph.numRoads(), 1);
+    EXPECT(!components[0].problem.mustCover.test(1));
+    EXPECT(!components[1].problem.allowed.test(1));
+    EXPECT_EQUAL(components[2].problem.graph.nameOf(0), "C");
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include <vector>
+
+namespace Disaster {
+    /* A piece of a larger instance, together with where its cities came from. */
+    struct Subproblem {
+        CoverProblem problem;
+        std::vector<CityId> original;  // Id in the parent instance of each city here
+    };
+
+    /* The instance restricted to the given cities, keeping their annotations. */
+    Subproblem restrictTo(const CoverProblem& problem, const std::vector<CityId>& cities);
+
+    /**
+     * Splits an instance into its connected components. Covers of different
+     * components never interact, so each can be solved on its own and the minimum
+     * for the whole instance is the sum of the per-component minima.
+     * Components are listed in order of their smallest city id.
+     */
+    std::vector<Subproblem> connectedComponents(const CoverProblem& problem);
+}
@@ -0,0 +1,165 @@
+#include "CoverState.h"
+#include <algorithm>
+using namespace std;
+
+namespace Disaster {
+    CoverState::CoverState(const CoverProblem& problem, const vector<CityBitset>& closed)
+        : mProblem(problem),
+          mClosed(closed),
+          mCoverCount(problem.graph.numCities(), 0),
+          mCandidates(problem.graph.numCities(), 0) {
+        mBaseCovered = CityBitset(problem.graph.numCities());
+        mBaseCovered.setAll();
+        mBaseCovered.andNot(problem.mustCover);
+
+        assign({}, problem.allowed);
+    }
+
+    void CoverState::place(CityId city) {
+        mTrail.push_back({ city, true });
+        mChosen.push_back(city);
+
+        for (CityId near: mProblem.graph.neighbors(city)) {
+            if (mCoverCount[near]++ == 0 && !mCovered.test(near)) {
+                mCovered.set(near);
+                mNumUncovered--;
+            }
+        }
+        if (mCoverCount[city]++ == 0 && !mCovered.test(city)) {
+            mCovered.set(city);
+            mNumUncovered--;
+        }
+    }
+
+    void CoverState::forbid(CityId city) {
+        if (!mAllowed.test(city)) return;
+        mTrail.push_back({ city, false });
+        mAllowed.reset(city);
+
+        for (CityId near: mProblem.graph.neighbors(city)) mCandidates[near]--;
+        mCandidates[city]--;
+    }
+
+    void CoverState::undo(size_t mark) {
+        /* Cities that never needed coverage stay covered no matter what. */
+        auto release = [&](CityId near) {
+            if (--mCoverCount[near] == 0 && !mBaseCovered.test(near)) {
+                mCovered.reset(near);
+                mNumUncovered++;
+            }
+        };
+
+        while (mTrail.size() > mark) {
+            Change change = mTrail.back();
+            mTrail.pop_back();
+
+            if (change.placed) {
+                mChosen.pop_back();
+                for (CityId near: mProblem.graph.neighbors(change.city)) release(near);
+                release(change.city);
+            } else {
+                mAllowed.set(change.city);
+                for (CityId near: mProblem.graph.neighbors(change.city)) mCandidates[near]++;
+                mCandidates[change.city]++;
+            }
+        }
+    }
+
+    void CoverState::assign(const vector<CityId>& chosen, const CityBitset& allowed) {
+        mTrail.clear();
+        mChosen.clear();
+        fill(mCoverCount.begin(), mCoverCount.end(), 0);
+        mCovered = mBaseCovered;
+        mAllowed = allowed;
+        mNumUncovered = mProblem.mustCover.count();
+
+        for (CityId city = 0; city < CityId(mProblem.graph.numCities()); city++) {
+            mCandidates[city] = mClosed[city].countAnd(allowed);
+        }
+
+        for (CityId city: chosen) place(city);
+        mTrail.clear();
+    }
+
+    int CoverState::mostConstrained() const {
+        int best = -1;
+        int bestOpen = 0;   // Uncovered cities in the best city's closed neighborhood
+
+        for (int w = 0; w < mCovered.numWords(); w++) {
+            uint64_t bits = ~mCovered.words()[w];
+            if (w == mCovered.numWords() - 1 && mCovered.size() % 64 != 0) {
+                bits &= (uint64_t(1) << (mCovered.size() % 64)) - 1;
+            }
+
+            for (; bits != 0; bits &= bits - 1) {
+                CityId city = CityId(w * 64 + lowestBit64(bits));
+                if (best != -1 && mCandidates[city] > mCandidates[best]) continue;
+
+                /* Among equally constrained cities, the one with the most covered
+                 * neighbors sits on the boundary of what's been decided so far.
+                 */
+                int open = mClosed[city].countAndNot(mCovered);
+                if (best == -1 || mCandidates[city] < mCandidates[best] || open < bestOpen) {
+                    best = int(city);
+                    bestOpen = open;
+                }
+            }
+        }
+        return best;
+    }
+}
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("CoverState counts overlapping coverage and undoes it exactly.") {
+    using namespace Disaster;
+
+    /* A path A - B - C - D, where D never needs coverage. */
+    CoverProblem problem{RoadGraph({ "A", "B", "C", "D" }, { { 0, 1 }, { 1, 2 }, { 2, 3 } })};
+    problem.mustCover.reset(3);
+    auto closed = closedNeighborhoods(problem.graph);
+
+    CoverState state(problem, closed);
+    EXPECT_EQUAL(state.numUncovered(), 3);
+    EXPECT(state.covered().test(3));
+
+    std::size_t start = state.mark();
+    state.place(1);
+    EXPECT_EQUAL(state.numUncovered(), 0);
+
+    /* C is covered twice now; taking back one placement must leave it covered. */
+    std::size_t middle = state.mark();
+    state.place(2);
+    state.forbid(0);
+    EXPECT_EQUAL(state.coverCount(2), 2);
+    EXPECT(!state.allowed().test(0));
+    EXPECT_EQUAL(state.numCandidates(0), 1);
+    EXPECT_EQUAL(state.numCandidates(1), 2);
+
+    state.undo(middle);
+    EXPECT(state.covered().test(2));
+    EXPECT_EQUAL(state.coverCount(2), 1);
+    EXPECT(state.allowed().test(0));
+    EXPECT(state.chosen() == std::vector<CityId>({ 1 }));
+
+    state.undo(start);
+    EXPECT_EQUAL(state.numUncovered(), 3);
+    EXPECT(!state.covered().test(2));
+    EXPECT(state.covered().test(3));
+    EXPECT(state.chosen().empty());
+    EXPECT_EQUAL(state.numCandidates(1), 3);
+
+    /* A has two candidates, B and C have three. */
+    EXPECT_EQUAL(state.mostConstrained(), 0);
+
+    /* Now A and C have one each and two uncovered cities nearby, so A wins on id. */
+    state.forbid(3);
+    state.forbid(1);
+    EXPECT_EQUAL(state.numCandidates(2), 1);
+    EXPECT_EQUAL(state.mostConstrained(), 0);
+
+    state.forbid(2);
+    EXPECT_EQUAL(state.numCandidates(2), 0);
+    EXPECT_EQUAL(state.mostConstrained(), 2);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include "CityBitset.h"
+#include <vector>
+
+namespace Disaster {
+    /**
+     * The mutable state of a search for covers: which cities hold supplies, how many
+     * of them cover each city, and which cities may still be picked. Every change is
+     * logged on a trail, so a search can make moves in place and backtrack to any
+     * earlier point exactly, rather than copying the state at each step.
+     * <p>
+     * Coverage is counted, not just flagged, so undoing one placement never uncovers
+     * a city that another placement still covers. Likewise, each city knows how many
+     * allowed cities could still cover it. Once the trail has grown to its deepest
+     * point, moves and undos don't allocate.
+     */
+    class CoverState {
+    public:
+        /* The state for the given instance with no supplies placed. The problem and the
+         * neighborhoods must outlive the state.
+         */
+        CoverState(const CoverProblem& problem, const std::vector<CityBitset>& closed);
+
+        /* Places supplies in a city. The city must be allowed and not already chosen. */
+        void place(CityId city);
+
+        /* Rules out a city as a supply location. */
+        void forbid(CityId city);
+
+        /* A point on the trail to undo back to. */
+        std::size_t mark() const {
+            return mTrail.size();
+        }
+
+        /* Undoes every change made since the given mark. */
+        void undo(std::size_t mark);
+
+        /* Resets to the given supplies and allowed cities, clearing the trail. */
+        void assign(const std::vector<CityId>& chosen, const CityBitset& allowed);
+
+        /* Cities covered, counting those that never needed coverage. */
+        const CityBitset& covered() const {
+            return mCovered;
+        }
+
+        const CityBitset& allowed() const {
+            return mAllowed;
+        }
+
+        /* Cities holding supplies, in the order they were placed. */
+        const std::vector<CityId>& chosen() const {
+            return mChosen;
+        }
+
+        /* How many cities with supplies cover the given city. */
+        int coverCount(CityId city) const {
+            return mCoverCount[city];
+        }
+
+        /* Cities that must be covered but aren't yet. */
+        int numUncovered() const {
+            return mNumUncovered;
+        }
+
+        /* How many allowed cities could cover the given city. */
+        int numCandidates(CityId city) const {
+            return mCandidates[city];
+        }
+
+        /* The uncovered city with the fewest candidates, or -1 if everything is
+         * covered. Ties go to the city with the fewest uncovered cities in its closed
+         * neighborhood, then to the smaller id.
+         */
+        int mostConstrained() const;
+
+    private:
+        /* One trail entry: a placement or a ruling-out of the given city. */
+        struct Change {
+            CityId city;
+            bool   placed;
+        };
+
+        const CoverProblem& mProblem;
+        const std::vector<CityBitset>& mClosed;
+
+        CityBitset mBaseCovered;          // Cities that never needed coverage
+        CityBitset mCovered;
+        CityBitset mAllowed;
+        std::vector<int> mCoverCount;
+        std::vector<int> mCandidates;     // Allowed cities in each closed neighborhood
+        std::vector<CityId> mChosen;
+        int mNumUncovered = 0;
+        std::vector<Change> mTrail;
+    };
+}
@@ -0,0 +1,329 @@
+#include "DynamicCover.h"
+#include "error.h"
+#include <algorithm>
+using namespace std;
+
+namespace Disaster {
+    DynamicCover::DynamicCover(const RoadGraph& graph)
+        : mRoads(graph.numCities()),
+          mLive(graph.numCities(), true),
+          mInCover(graph.numCities(), false),
+          mCoverage(graph.numCities(), 0),
+          mNumCities(graph.numCities()) {
+        for (CityId city = 0; city < CityId(graph.numCities()); city++) {
+            mNames.push_back(graph.nameOf(city));
+            mIndex[graph.nameOf(city)] = city;
+            mRoads[city].assign(graph.neighbors(city).begin(), graph.neighbors(city).end());
+        }
+
+        vector<CityId> greedy;
+        greedySupplyCover(CoverProblem(graph), greedy);
+        for (CityId city: greedy) supply(city);
+
+        /* Greedy picks early cities that later picks make redundant. */
+        for (CityId city: greedy) {
+            if (isRedundant(city)) unsupply(city);
+        }
+    }
+
+    CityId DynamicCover::addCity(const string& name) {
+        if (mIndex.count(name)) {
+            error("Duplicate city: " + name);
+        }
+
+        CityId city = CityId(mNames.size());
+        mNames.push_back(name);
+        mIndex[name] = city;
+        mRoads.emplace_back();
+        mLive.push_back(true);
+        mInCover.push_back(false);
+        mCoverage.push_back(0);
+        mNumCities++;
+        mStats.edits++;
+
+        supply(city);
+        mStats.repairs++;
+        return city;
+    }
+
+    void DynamicCover::removeCity(CityId city) {
+        checkCity(city);
+
+        /* Its supplies go first, so the neighbors see it as gone. */
+        if (mInCover[city]) unsupply(city);
+        vector<CityId> neighbors = move(mRoads[city]);
+        for (CityId neighbor: neighbors) {
+            auto& roads = mRoads[neighbor];
+            roads.erase(find(roads.begin(), roads.end(), city));
+        }
+
+        mLive[city] = false;
+        mIndex.erase(mNames[city]);
+        mNumCities--;
+        mStats.edits++;
+
+        /* Neighbors may be stranded, or have supplies only the city needed. */
+        for (CityId neighbor: neighbors) {
+            if (mCoverage[neighbor] == 0) repair(neighbor);
+        }
+        for (CityId neighbor: neighbors) pruneIfRedundant(neighbor);
+    }
+
+    void DynamicCover::addRoad(CityId from, CityId to) {
+        checkCity(from);
+        checkCity(to);
+        if (from == to) {
+            error("A road must join two different cities.");
+        }
+        if (find(mRoads[from].begin(), mRoads[from].end(), to) != mRoads[from].end()) return;
+
+        mRoads[from].push_back(to);
+        mRoads[to].push_back(from);
+        mCoverage[from] += mInCover[to];
+        mCoverage[to] += mInCover[from];
+        mStats.edits++;
+
+        /* More coverage can only make supplies redundant, and only those next to it. */
+        pruneNear(from);
+        pruneNear(to);
+    }
+
+    void DynamicCover::removeRoad(CityId from, CityId to) {
+        checkCity(from);
+        checkCity(to);
+        auto& fromRoads = mRoads[from];
+        auto itr = find(fromRoads.begin(), fromRoads.end(), to);
+        if (itr == fromRoads.end()) {
+            error("No road between " + mNames[from] + " and " + mNames[to]);
+        }
+
+        *itr = fromRoads.back();
+        fromRoads.pop_back();
+        auto& toRoads = mRoads[to];
+        *find(toRoads.begin(), toRoads.end(), from) = toRoads.back();
+        toRoads.pop_back();
+
+        mCoverage[from] -= mInCover[to];
+        mCoverage[to] -= mInCover[from];
+        mStats.edits++;
+
+        /* Less coverage can only strand the road's own ends, and a supply at either
+         * end no longer has to reach the other.
+         */
+        if (mCoverage[from] == 0) repair(from);
+        if (mCoverage[to] == 0) repair(to);
+        pruneIfRedundant(from);
+        pruneIfRedundant(to);
+    }
+
+    void DynamicCover::reoptimize(const SolverOptions& options) {
+        vector<CityId> original;
+        RoadGraph graph = snapshot(original);
+
+        for (CityId city: cover()) unsupply(city);
+        for (CityId city: findMinimumCover(graph, options)) supply(original[city]);
+        mStats.reoptimizations++;
+    }
+
+    RoadGraph DynamicCover::snapshot(vector<CityId>& original) const {
+        vector<CityId> renumbered(mNames.size());
+        vector<string> names;
+        original.clear();
+        for (CityId city = 0; city < CityId(mNames.size()); city++) {
+            if (!mLive[city]) continue;
+            renumbered[city] = CityId(names.size());
+            names.push_back(mNames[city]);
+            original.push_back(city);
+        }
+
+        vector<pair<CityId, CityId>> roads;
+        for (CityId city: original) {
+            for (CityId neighbor: mRoads[city]) {
+                if (city < neighbor) roads.emplace_back(renumbered[city], renumbered[neighbor]);
+            }
+        }
+        return RoadGraph(names, roads);
+    }
+
+    vector<CityId> DynamicCover::cover() const {
+        vector<CityId> result;
+        for (CityId city = 0; city < CityId(mInCover.size()); city++) {
+            if (mInCover[city]) result.push_back(city);
+        }
+        return result;
+    }
+
+    CityId DynamicCover::idOf(const string& name) const {
+        auto itr = mIndex.find(name);
+        if (itr == mIndex.end()) {
+            error("Unknown city: " + name);
+        }
+        return itr->second;
+    }
+
+    void DynamicCover::checkCity(CityId city) const {
+        if (!contains(city)) {
+            error("No city with id " + to_string(city));
+        }
+    }
+
+    void DynamicCover::supply(CityId city) {
+        mInCover[city] = true;
+        mCoverSize++;
+        mCoverage[city]++;
+        for (CityId neighbor: mRoads[city]) mCoverage[neighbor]++;
+    }
+
+    void DynamicCover::unsupply(CityId city) {
+        mInCover[city] = false;
+        mCoverSize--;
+        mCoverage[city]--;
+        for (CityId neighbor: mRoads[city]) mCoverage[neighbor]--;
+    }
+
+    /* Any of the stranded city and its neighbors would do; the one with the most
+     * roads has the best chance of making other supplies redundant.
+     */
+    void DynamicCover::repair(CityId stranded) {
+        CityId best = stranded;
+        for (CityId neighbor: mRoads[stranded]) {
+            if (mRoads[neighbor].size() > mRoads[best].size()) best = neighbor;
+        }
+
+        supply(best);
+        mStats.repairs++;
+
+        pruneNear(best);
+        for (CityId neighbor: mRoads[best]) pruneNear(neighbor);
+    }
+
+    /* The city's coverage went up, so the supplies reaching it may not be needed. */
+    void DynamicCover::pruneNear(CityId city) {
+        pruneIfRedundant(city);
+        for (CityId neighbor: mRoads[city]) pruneIfRedundant(neighbor);
+    }
+
+    void DynamicCover::pruneIfRedundant(CityId city) {
+        if (mInCover[city] && isRedundant(city)) {
+            unsupply(city);
+            mStats.prunes++;
+        }
+    }
+
+    /* A supplier is redundant if everything it reaches is reached by another. */
+    bool DynamicCover::isRedundant(CityId supplier) const {
+        if (mCoverage[supplier] < 2) return false;
+        for (CityId neighbor: mRoads[supplier]) {
+            if (mCoverage[neighbor] < 2) return false;
+        }
+        return true;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+namespace {
+    /* Every live city is covered, and no supply could be dropped. */
+    bool isIrredundantCover(const Disaster::DynamicCover& dynamic) {
+        std::vector<Disaster::CityId> original;
+        Disaster::RoadGraph graph = dynamic.snapshot(original);
+
+        std::vector<int> coverage(graph.numCities(), 0);
+        for (Disaster::CityId city = 0; city < Disaster::CityId(graph.numCities()); city++) {
+            if (!dynamic.hasSupplies(original[city])) continue;
+            coverage[city]++;
+            for (Disaster::CityId neighbor: graph.neighbors(city)) coverage[neighbor]++;
+        }
+
+        for (Disaster::CityId city = 0; city < Disaster::CityId(graph.numCities()); city++) {
+            if (coverage[city] == 0 || coverage[city] != dynamic.coverage(original[city])) return false;
+            if (!dynamic.hasSupplies(original[city]) || coverage[city] < 2) continue;
+
+            bool needed = false;
+            for (Disaster::CityId neighbor: graph.neighbors(city)) needed = needed || coverage[neighbor] < 2;
+            if (!needed) return false;
+        }
+        return true;
+    }
+}
+
+STUDENT_TEST("DynamicCover keeps an irredundant cover through random edits.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(25);
+    for (int round = 0; round < 20; round++) {
+        int numCities = 1 + int(generator() % 20);
+        DynamicCover dynamic(randomNetwork(generator, numCities, 20));
+        EXPECT(isIrredundantCover(dynamic));
+
+        int added = 0;
+        for (int edit = 0; edit < 200; edit++) {
+            std::vector<CityId> live;
+            for (CityId city = 0; city < CityId(numCities + added); city++) {
+                if (dynamic.contains(city)) live.push_back(city);
+            }
+
+            int kind = int(generator() % 10);
+            if (live.size() < 2 || kind == 0) {
+                dynamic.addCity("new " + std::to_string(added++));
+            } else if (kind == 1) {
+                dynamic.removeCity(live[generator() % live.size()]);
+            } else {
+                CityId from = live[generator() % live.size()];
+                CityId to = live[generator() % live.size()];
+                if (from == to) continue;
+
+                std::vector<CityId> original;
+                RoadGraph graph = dynamic.snapshot(original);
+                auto at = [&](CityId city) {
+                    return CityId(std::find(original.begin(), original.end(), city) - original.begin());
+                };
+                if (graph.isAdjacent(at(from), at(to))) {
+                    dynamic.removeRoad(from, to);
+                } else {
+                    dynamic.addRoad(from, to);
+                }
+            }
+            EXPECT(isIrredundantCover(dynamic));
+            EXPECT_EQUAL(dynamic.coverSize(), int(dynamic.cover().size()));
+        }
+
+        /* On demand, the cover becomes a minimum one. */
+        std::vector<CityId> original;
+        int minimum = int(findMinimumCover(dynamic.snapshot(original)).size());
+        dynamic.reoptimize();
+        EXPECT_EQUAL(dynamic.coverSize(), minimum);
+        EXPECT(isIrredundantCover(dynamic));
+    }
+}
+
+STUDENT_TEST("DynamicCover edits take time proportional to the cities they touch.") {
+    using namespace Disaster;
+
+    /* A 100 x 100 grid, with 20,000 road cuts and restorations. */
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int row = 0; row < 100; row++) {
+        for (int col = 0; col < 100; col++) {
+            CityId id = CityId(names.size());
+            names.push_back(std::to_string(row) + "," + std::to_string(col));
+            if (row > 0) roads.emplace_back(id, id - 100);
+            if (col > 0) roads.emplace_back(id, id - 1);
+        }
+    }
+    DynamicCover dynamic(RoadGraph(names, roads));
+
+    std::mt19937 generator(25);
+    EXPECT_COMPLETES_IN(1.0,
+        for (int edit = 0; edit < 10000; edit++) {
+            auto road = roads[generator() % roads.size()];
+            dynamic.removeRoad(road.first, road.second);
+            dynamic.addRoad(road.first, road.second);
+        }
+    );
+    EXPECT_EQUAL(dynamic.stats().edits, 20000);
+    EXPECT(isIrredundantCover(dynamic));
+}
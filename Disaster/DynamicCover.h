@@ -0,0 +1,115 @@
+#pragma once
+
+#include "RoadGraph.h"
+#include "Solver.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Disaster {
+    /* What a DynamicCover has done since it was created. */
+    struct DynamicCoverStats {
+        long long edits = 0;            // Cities and roads added or removed
+        long long repairs = 0;          // Supplies added to cover stranded cities
+        long long prunes = 0;           // Supplies dropped because others covered their cities
+        long long reoptimizations = 0;  // Calls to reoptimize
+    };
+
+    /**
+     * A cover of a road network that's being edited, kept valid after every edit by
+     * repairing it locally instead of solving again.
+     * <p>
+     * Besides the cover, each city tracks how many supplies are in its closed
+     * neighborhood. An edit only changes those counts around the cities it touches,
+     * so only those cities can end up stranded, and only supplies near them can end
+     * up redundant. A stranded city gets supplies at whichever of it and its
+     * neighbors reaches the most cities, and then any supply within two roads of
+     * that one whose cities are all covered twice over is dropped. Edits therefore
+     * cost time proportional to the degrees around them, not to the network.
+     * <p>
+     * The cover always covers every city and never has a supply it could do without,
+     * but after a while of edits it may be larger than necessary. reoptimize replaces
+     * it with a minimum cover from the full solver pipeline.
+     * <p>
+     * City ids stay fixed through edits. Removing a city retires its id, and adding a
+     * city gives it a new one.
+     */
+    class DynamicCover {
+    public:
+        /* Starts from a greedy cover of the network, with redundant supplies dropped. */
+        explicit DynamicCover(const RoadGraph& graph);
+
+        /* Adds a city with no roads, which needs supplies of its own. Returns its id. */
+        CityId addCity(const std::string& name);
+
+        /* Removes a city and all its roads. */
+        void removeCity(CityId city);
+
+        /* Adds a road between two different cities. Adding a road twice does nothing. */
+        void addRoad(CityId from, CityId to);
+
+        /* Removes the road between two cities, which must exist. */
+        void removeRoad(CityId from, CityId to);
+
+        /* Replaces the cover with a minimum one for the network as it stands. */
+        void reoptimize(const SolverOptions& options = {});
+
+        /**
+         * The network as it stands, with cities renumbered densely.
+         *
+         * @param original An outparameter filled in with each city's id in this object.
+         * @return The current road network.
+         */
+        RoadGraph snapshot(std::vector<CityId>& original) const;
+
+        /* The current cover, in increasing order of id. */
+        std::vector<CityId> cover() const;
+
+        int coverSize() const {
+            return mCoverSize;
+        }
+        int numCities() const {
+            return mNumCities;
+        }
+
+        bool contains(CityId city) const {
+            return city < mLive.size() && mLive[city];
+        }
+        bool hasSupplies(CityId city) const {
+            return mInCover[city];
+        }
+
+        /* How many supplies reach the city, its own included. */
+        int coverage(CityId city) const {
+            return mCoverage[city];
+        }
+
+        CityId idOf(const std::string& name) const;
+        const std::string& nameOf(CityId city) const {
+            return mNames[city];
+        }
+
+        const DynamicCoverStats& stats() const {
+            return mStats;
+        }
+
+    private:
+        std::vector<std::string> mNames;
+        std::unordered_map<std::string, CityId> mIndex;  // Live cities only
+        std::vector<std::vector<CityId>> mRoads;         // Each city's neighbors, unordered
+        std::vector<bool> mLive;
+        std::vector<bool> mInCover;
+        std::vector<int> mCoverage;                      // Supplies in each city's closed neighborhood
+        int mNumCities = 0;
+        int mCoverSize = 0;
+        DynamicCoverStats mStats;
+
+        void checkCity(CityId city) const;
+        void supply(CityId city);
+        void unsupply(CityId city);
+        void repair(CityId stranded);
+        void pruneNear(CityId city);
+        void pruneIfRedundant(CityId city);
+        bool isRedundant(CityId supplier) const;
+    };
+}
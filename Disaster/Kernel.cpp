@@ -0,0 +1,376 @@
+#include "Kernel.h"
+#include <iomanip>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* Mutable working copy of the instance. Adjacency is a bitset per city so
+         * deleting roads and testing neighborhood containment are both cheap.
+         */
+        class Reducer {
+        public:
+            Reducer(const CoverProblem& problem, Kernel& kernel)
+                : mGraph(problem.graph),
+                  mKernel(kernel),
+                  mNeed(problem.mustCover),
+                  mAllow(problem.allowed),
+                  mAlive(problem.graph.numCities()),
+                  mScratch(problem.graph.numCities()),
+                  mOther(problem.graph.numCities()) {
+                mAlive.setAll();
+                mAdjacent.assign(mGraph.numCities(), CityBitset(mGraph.numCities()));
+                for (CityId city = 0; city < CityId(mGraph.numCities()); city++) {
+                    for (CityId neighbor: mGraph.neighbors(city)) {
+                        mAdjacent[city].set(neighbor);
+                    }
+                }
+            }
+
+            void run() {
+                bool changed = true;
+                while (changed && !mKernel.infeasible) {
+                    changed = false;
+                    changed |= removeIrrelevantCities();
+                    changed |= removeIrrelevantRoads();
+                    changed |= pickIsolatedCities();
+                    changed |= pickPendantNeighbors();
+                    changed |= pickSingleOptions();
+                    changed |= removeDominatedSuppliers();
+                    changed |= removeDominatedTargets();
+                }
+                buildKernel();
+            }
+
+        private:
+            const RoadGraph& mGraph;
+            Kernel& mKernel;
+            CityBitset mNeed, mAllow, mAlive;
+            vector<CityBitset> mAdjacent;
+            CityBitset mScratch, mOther;
+
+            int degree(CityId city) const {
+                return mAdjacent[city].count();
+            }
+
+            /* out = N[city] ∩ mNeed. */
+            void needyNeighborhood(CityId city, CityBitset& out) const {
+                out = mAdjacent[city];
+                out.set(city);
+                out &= mNeed;
+            }
+
+            /* out = allowed cities that could cover city. */
+            void optionsFor(CityId city, CityBitset& out) const {
+                out = mAdjacent[city];
+                out.set(city);
+                out &= mAllow;
+            }
+
+            void deleteRoad(CityId from, CityId to, ReductionRule rule) {
+                mAdjacent[from].reset(to);
+                mAdjacent[to].reset(from);
+                mKernel.stats[rule].roadsRemoved++;
+            }
+
+            void deleteCity(CityId city, ReductionRule rule) {
+                mAdjacent[city].forEach([&](CityId neighbor) {
+                    deleteRoad(city, neighbor, rule);
+                });
+                mAlive.reset(city);
+                mNeed.reset(city);
+                mAllow.reset(city);
+                mKernel.stats[rule].citiesRemoved++;
+            }
+
+            /* Commits to putting supplies in the given city. */
+            void pick(CityId city, ReductionRule rule) {
+                mKernel.forced.push_back(city);
+                mKernel.stats[rule].applications++;
+
+                mNeed.reset(city);
+                mAdjacent[city].forEach([&](CityId neighbor) {
+                    mNeed.reset(neighbor);
+                });
+                deleteCity(city, rule);
+            }
+
+            bool removeIrrelevantCities() {
+                bool changed = false;
+                mAlive.forEach([&](CityId city) {
+                    if (mAlive.test(city) && !mNeed.test(city) && !mAllow.test(city)) {
+                        deleteCity(city, ReductionRule::IRRELEVANT_CITY);
+                        mKernel.stats[ReductionRule::IRRELEVANT_CITY].applications++;
+                        changed = true;
+                    }
+                });
+                return changed;
+            }
+
+            /* A road matters only if one end could supply the other end, which needs it. */
+            bool removeIrrelevantRoads() {
+                bool changed = false;
+                mAlive.forEach([&](CityId city) {
+                    mAdjacent[city].forEach([&](CityId neighbor) {
+                        if (neighbor < city) return;
+                        bool useful = (mAllow.test(city) && mNeed.test(neighbor)) ||
+                                      (mAllow.test(neighbor) && mNeed.test(city));
+                        if (!useful) {
+                            deleteRoad(city, neighbor, ReductionRule::IRRELEVANT_ROAD);
+                            mKernel.stats[ReductionRule::IRRELEVANT_ROAD].applications++;
+                            changed = true;
+                        }
+                    });
+                });
+                return changed;
+            }
+
+            bool pickIsolatedCities() {
+                bool changed = false;
+                mAlive.forEach([&](CityId city) {
+                    if (!mAlive.test(city) || degree(city) != 0) return;
+
+                    if (!mNeed.test(city)) {
+                        deleteCity(city, ReductionRule::ISOLATED_CITY);
+                        mKernel.stats[ReductionRule::ISOLATED_CITY].applications++;
+                    } else if (mAllow.test(city)) {
+                        pick(city, ReductionRule::ISOLATED_CITY);
+                    } else {
+                        mKernel.infeasible = true;
+                    }
+                    changed = true;
+                });
+                return changed;
+            }
+
+            /* If a city needing coverage has a single road, its neighbor covers everything
+             * the city itself would, so the neighbor might as well hold the supplies.
+             */
+            bool pickPendantNeighbors() {
+                bool changed = false;
+                mAlive.forEach([&](CityId city) {
+                    if (!mAlive.test(city) || !mNeed.test(city) || degree(city) != 1) return;
+
+                    CityId neighbor = CityId(mAdjacent[city].firstSet());
+                    if (mAllow.test(neighbor)) {
+                        pick(neighbor, ReductionRule::PENDANT_CITY);
+                        changed = true;
+                    }
+                });
+                return changed;
+            }
+
+            bool pickSingleOptions() {
+                bool changed = false;
+                mAlive.forEach([&](CityId city) {
+                    if (!mAlive.test(city) || !mNeed.test(city)) return;
+
+                    optionsFor(city, mScratch);
+                    int numOptions = mScratch.count();
+                    if (numOptions == 0) {
+                        mKernel.infeasible = true;
+                    } else if (numOptions == 1) {
+                        pick(CityId(mScratch.firstSet()), ReductionRule::SINGLE_OPTION);
+                        changed = true;
+                    }
+                });
+                return changed;
+            }
+
+            /* If every needy city that u could cover is also covered by v, any solution
+             * using u can use v instead. Ties are broken toward keeping the smaller id.
+             */
+            bool removeDominatedSuppliers() {
+                bool changed = false;
+                CityBitset theirs(mGraph.numCities());
+
+                mAlive.forEach([&](CityId city) {
+                    if (!mAlive.test(city) || !mAllow.test(city)) return;
+
+                    needyNeighborhood(city, mScratch);
+                    int anchor = mScratch.firstSet();
+
+                    /* Covers nothing that needs it? Then it's useless as a supplier. */
+                    if (anchor == -1) {
+                        mAllow.reset(city);
+                        mKernel.stats[ReductionRule::DOMINATED_SUPPLIER].applications++;
+                        changed = true;
+                        return;
+                    }
+
+                    /* Any dominator must also cover the anchor, so it lives in N[anchor]. */
+                    optionsFor(CityId(anchor), mOther);
+                    mOther.reset(city);
+                    for (int other = mOther.firstSet(); other != -1; other = mOther.nextSet(other + 1)) {
+                        needyNeighborhood(CityId(other), theirs);
+                        if (!mScratch.isSubsetOf(theirs)) continue;
+                        if (mScratch == theirs && CityId(other) > city) continue;
+
+                        mAllow.reset(city);
+                        mKernel.stats[ReductionRule::DOMINATED_SUPPLIER].applications++;
+                        changed = true;
+                        return;
+                    }
+                });
+                return changed;
+            }
+
+            /* If every supplier that could cover u also covers v, covering u covers v for
+             * free, so v no longer needs tracking. Ties keep the smaller id.
+             */
+            bool removeDominatedTargets() {
+                bool changed = false;
+                CityBitset theirs(mGraph.numCities());
+
+                mAlive.forEach([&](CityId city) {
+                    if (!mAlive.test(city) || !mNeed.test(city)) return;
+
+                    optionsFor(city, mScratch);
+                    int anchor = mScratch.firstSet();
+                    if (anchor == -1) return;
+
+                    /* Anything city dominates is covered by anchor, so lives in N[anchor]. */
+                    mOther = mAdjacent[anchor];
+                    mOther.set(CityId(anchor));
+                    mOther &= mNeed;
+                    mOther.reset(city);
+                    for (int other = mOther.firstSet(); other != -1; other = mOther.nextSet(other + 1)) {
+                        optionsFor(CityId(other), theirs);
+                        if (!mScratch.isSubsetOf(theirs)) continue;
+                        if (mScratch == theirs && CityId(other) < city) continue;
+
+                        mNeed.reset(CityId(other));
+                        mKernel.stats[ReductionRule::DOMINATED_TARGET].applications++;
+                        changed = true;
+                    }
+                });
+                return changed;
+            }
+
+            void buildKernel() {
+                vector<CityId> renumber(mGraph.numCities(), CityId(-1));
+                vector<string> names;
+                mAlive.forEach([&](CityId city) {
+                    renumber[city] = CityId(names.size());
+                    names.push_back(mGraph.nameOf(city));
+                    mKernel.original.push_back(city);
+                });
+
+                vector<pair<CityId, CityId>> roads;
+                mAlive.forEach([&](CityId city) {
+                    mAdjacent[city].forEach([&](CityId neighbor) {
+                        if (city < neighbor) roads.emplace_back(renumber[city], renumber[neighbor]);
+                    });
+                });
+
+                CoverProblem& result = mKernel.problem;
+                result.graph     = RoadGraph(std::move(names), roads);
+                result.mustCover = CityBitset(result.graph.numCities());
+                result.allowed   = CityBitset(result.graph.numCities());
+                for (CityId city = 0; city < CityId(result.graph.numCities()); city++) {
+                    if (mNeed.test(mKernel.original[city]))  result.mustCover.set(city);
+                    if (mAllow.test(mKernel.original[city])) result.allowed.set(city);
+                }
+
+                KernelStats& stats = mKernel.stats;
+                stats.originalCities = mGraph.numCities();
+                stats.originalRoads  = mGraph.numRoads();
+                stats.kernelCities   = result.graph.numCities();
+                stats.kernelRoads    = result.graph.numRoads();
+                stats.forcedSupplies = int(mKernel.forced.size());
+            }
+        };
+    }
+
+    string nameOf(ReductionRule rule) {
+        switch (rule) {
+            case ReductionRule::IRRELEVANT_CITY:    return "irrelevant city";
+            case ReductionRule::IRRELEVANT_ROAD:    return "irrelevant road";
+            case ReductionRule::ISOLATED_CITY:      return "isolated city";
+            case ReductionRule::PENDANT_CITY:       return "pendant city";
+            case ReductionRule::SINGLE_OPTION:      return "single option";
+            case ReductionRule::DOMINATED_SUPPLIER: return "dominated supplier";
+            case ReductionRule::DOMINATED_TARGET:   return "dominated target";
+            default: return "unknown rule";
+        }
+    }
+
+    ostream& operator<< (ostream& out, const KernelStats& stats) {
+        out << "Kernel: " << stats.originalCities << " cities / " << stats.originalRoads << " roads -> "
+            << stats.kernelCities << " cities / " << stats.kernelRoads << " roads, "
+            << stats.forcedSupplies << " forced supplies" << endl;
+        for (int i = 0; i < int(ReductionRule::NUM_RULES); i++) {
+            const RuleStats& rule = stats.rules[i];
+            out << "  " << left << setw(20) << nameOf(ReductionRule(i)) << right
+                << setw(6) << rule.applications  << " applied, "
+                << setw(6) << rule.citiesRemoved << " cities, "
+                << setw(6) << rule.roadsRemoved  << " roads removed" << endl;
+        }
+        return out;
+    }
+
+    vector<CityId> Kernel::lift(const vector<CityId>& kernelCover) const {
+        vector<CityId> result = forced;
+        for (CityId city: kernelCover) {
+            result.push_back(original[city]);
+        }
+        return result;
+    }
+
+    Kernel kernelize(const CoverProblem& problem) {
+        Kernel result;
+        Reducer(problem, result).run();
+        return result;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("kernelize erases a rail line and reports what each rule did.") {
+    using namespace Disaster;
+
+    /* A - B - C - D - E - F - G needs three cities. */
+    RoadGraph line({ "A", "B", "C", "D", "E", "F", "G" },
+                   { { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 5 }, { 5, 6 } });
+    Kernel kernel = kernelize(CoverProblem(line));
+
+    EXPECT(!kernel.infeasible);
+    EXPECT_EQUAL(kernel.problem.graph.numCities(), 0);
+    EXPECT_EQUAL(kernel.forced.size(), 3);
+    EXPECT(isValidCover(CoverProblem(line), kernel.lift({})));
+
+    EXPECT_GREATER_THAN(kernel.stats[ReductionRule::PENDANT_CITY].applications, 0);
+
+    int citiesRemoved = 0, roadsRemoved = 0;
+    for (const auto& rule: kernel.stats.rules) {
+        citiesRemoved += rule.citiesRemoved;
+        roadsRemoved  += rule.roadsRemoved;
+    }
+    EXPECT_EQUAL(citiesRemoved, 7);
+    EXPECT_EQUAL(roadsRemoved, 6);
+}
+
+STUDENT_TEST("kernelize preserves the optimum on random networks.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(106);
+    for (int trial = 0; trial < 200; trial++) {
+        CoverProblem problem = randomProblem(generator, 18, 25);
+
+        std::vector<CityId> direct;
+        bool feasible = findMinimumSupplyCover(problem, direct);
+
+        Kernel kernel = kernelize(problem);
+        EXPECT_EQUAL(kernel.infeasible, !feasible);
+        if (!feasible) continue;
+
+        std::vector<CityId> rest;
+        EXPECT(findMinimumSupplyCover(kernel.problem, rest));
+
+        std::vector<CityId> lifted = kernel.lift(rest);
+        EXPECT_EQUAL(lifted.size(), direct.size());
+        EXPECT(isValidCover(problem, lifted));
+    }
+}
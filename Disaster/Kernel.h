@@ -0,0 +1,76 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Disaster {
+    /* The safe reduction rules applied by kernelize(). */
+    enum class ReductionRule {
+        IRRELEVANT_CITY,     // Covered city that can't hold supplies: delete it
+        IRRELEVANT_ROAD,     // Road that can't help cover anything: delete it
+        ISOLATED_CITY,       // City with no roads left: supplies go there if it needs them
+        PENDANT_CITY,        // Degree-1 city needing coverage: supplies go to its neighbor
+        SINGLE_OPTION,       // City with exactly one possible supplier: use that supplier
+        DOMINATED_SUPPLIER,  // N[u] ⊆ N[v] on uncovered cities: never put supplies in u
+        DOMINATED_TARGET,    // Whatever covers u also covers v: stop tracking v
+
+        NUM_RULES
+    };
+
+    /* Human-readable name of a rule. */
+    std::string nameOf(ReductionRule rule);
+
+    /* What one reduction rule accomplished. */
+    struct RuleStats {
+        int applications  = 0;
+        int citiesRemoved = 0;
+        int roadsRemoved  = 0;
+    };
+
+    /* What the whole kernelization pass accomplished, broken down by rule. */
+    struct KernelStats {
+        RuleStats rules[int(ReductionRule::NUM_RULES)];
+
+        int originalCities = 0, originalRoads = 0;
+        int kernelCities   = 0, kernelRoads   = 0;
+        int forcedSupplies = 0;
+
+        RuleStats& operator[] (ReductionRule rule) {
+            return rules[int(rule)];
+        }
+        const RuleStats& operator[] (ReductionRule rule) const {
+            return rules[int(rule)];
+        }
+    };
+
+    std::ostream& operator<< (std::ostream& out, const KernelStats& stats);
+
+    /**
+     * The result of kernelizing a road network: a (usually much) smaller annotated
+     * instance, plus the supply locations that every optimal solution can be assumed
+     * to use. An optimal cover of the original network is forced plus an optimal cover
+     * of the kernel.
+     */
+    struct Kernel {
+        CoverProblem problem;          // What's left to solve
+        std::vector<CityId> original;  // Original id of each kernel city
+        std::vector<CityId> forced;    // Original ids of cities that must hold supplies
+        bool infeasible = false;       // Some city can't be covered at all
+        KernelStats stats;
+
+        /* Translates a cover of the kernel into a cover of the original network,
+         * including the forced cities.
+         */
+        std::vector<CityId> lift(const std::vector<CityId>& kernelCover) const;
+    };
+
+    /**
+     * Repeatedly applies safe reduction rules to a dominating-set instance until none
+     * applies. Each rule either records a city that can be assumed to hold supplies,
+     * or deletes cities, roads, or covering obligations without changing the optimum.
+     * Tree-like networks (rail lines, spurs) typically vanish entirely.
+     */
+    Kernel kernelize(const CoverProblem& problem);
+}
@@ -0,0 +1,443 @@
+#include "MeasureConquer.h"
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /**
+         * A maximum matching in a general graph by Edmonds' blossom algorithm, in time
+         * O(V^3). Each phase grows an alternating tree from an unmatched vertex, and an
+         * odd cycle (a blossom) gets contracted into its base so the search can see
+         * through it.
+         */
+        class BlossomMatching {
+        public:
+            BlossomMatching(int numVertices, const vector<pair<int, int>>& edges)
+                : mAdjacent(numVertices), mMate(numVertices, -1), mParent(numVertices),
+                  mBase(numVertices), mUsed(numVertices), mInBlossom(numVertices) {
+                for (auto [from, to]: edges) {
+                    mAdjacent[from].push_back(to);
+                    mAdjacent[to].push_back(from);
+                }
+
+                /* A greedy matching leaves fewer augmenting paths to find. */
+                for (auto [from, to]: edges) {
+                    if (mMate[from] == -1 && mMate[to] == -1) {
+                        mMate[from] = to;
+                        mMate[to] = from;
+                    }
+                }
+
+                for (int root = 0; root < numVertices; root++) {
+                    if (mMate[root] != -1) continue;
+                    for (int end = augmentingPath(root); end != -1; ) {
+                        int previous = mParent[end];
+                        int next = mMate[previous];
+                        mMate[end] = previous;
+                        mMate[previous] = end;
+                        end = next;
+                    }
+                }
+            }
+
+            /* The vertex matched with the given one, or -1 if it's unmatched. */
+            int mate(int vertex) const {
+                return mMate[vertex];
+            }
+
+        private:
+            vector<vector<int>> mAdjacent;
+            vector<int> mMate, mParent, mBase;
+            vector<char> mUsed, mInBlossom;
+
+            /* The base of the smallest blossom containing both vertices' tree paths. */
+            int commonAncestor(int lhs, int rhs) {
+                vector<char> seen(mMate.size(), false);
+                while (true) {
+                    lhs = mBase[lhs];
+                    seen[lhs] = true;
+                    if (mMate[lhs] == -1) break;
+                    lhs = mParent[mMate[lhs]];
+                }
+                while (true) {
+                    rhs = mBase[rhs];
+                    if (seen[rhs]) return rhs;
+                    rhs = mParent[mMate[rhs]];
+                }
+            }
+
+            void markPath(int vertex, int base, int child) {
+                while (mBase[vertex] != base) {
+                    mInBlossom[mBase[vertex]] = mInBlossom[mBase[mMate[vertex]]] = true;
+                    mParent[vertex] = child;
+                    child = mMate[vertex];
+                    vertex = mParent[mMate[vertex]];
+                }
+            }
+
+            /* Returns the unmatched end of an augmenting path from root, or -1. */
+            int augmentingPath(int root) {
+                int numVertices = int(mMate.size());
+                fill(mUsed.begin(), mUsed.end(), false);
+                fill(mParent.begin(), mParent.end(), -1);
+                for (int i = 0; i < numVertices; i++) mBase[i] = i;
+
+                mUsed[root] = true;
+                vector<int> queue = { root };
+                for (size_t head = 0; head < queue.size(); head++) {
+                    int vertex = queue[head];
+                    for (int next: mAdjacent[vertex]) {
+                        if (mBase[vertex] == mBase[next] || mMate[vertex] == next) continue;
+
+                        if (next == root || (mMate[next] != -1 && mParent[mMate[next]] != -1)) {
+                            int base = commonAncestor(vertex, next);
+                            fill(mInBlossom.begin(), mInBlossom.end(), false);
+                            markPath(vertex, base, next);
+                            markPath(next, base, vertex);
+                            for (int i = 0; i < numVertices; i++) {
+                                if (!mInBlossom[mBase[i]]) continue;
+                                mBase[i] = base;
+                                if (!mUsed[i]) {
+                                    mUsed[i] = true;
+                                    queue.push_back(i);
+                                }
+                            }
+                        } else if (mParent[next] == -1) {
+                            mParent[next] = vertex;
+                            if (mMate[next] == -1) return next;
+                            mUsed[mMate[next]] = true;
+                            queue.push_back(mMate[next]);
+                        }
+                    }
+                }
+                return -1;
+            }
+        };
+
+        /* The search proper. Sets are closed neighborhoods of live cities, minus the
+         * covered cities; live cities shrink as sets are taken or discarded.
+         */
+        class MeasureConquer {
+        public:
+            SearchStats stats;
+            vector<CityId> best;
+            int bestSize;
+            bool found = false;
+
+            MeasureConquer(const CoverProblem& problem, int bestSize, const SearchControl& control)
+                : bestSize(bestSize),
+                  mProblem(problem),
+                  mControl(control),
+                  mClosed(closedNeighborhoods(problem.graph)) {
+            }
+
+            void run() {
+                CityBitset covered = mProblem.mustCover;
+                covered.setAll();
+                covered.andNot(mProblem.mustCover);
+                search(mProblem.allowed, covered);
+            }
+
+        private:
+            const CoverProblem& mProblem;
+            const SearchControl& mControl;
+            vector<CityBitset> mClosed;
+            vector<CityId> mChosen;  // Sets taken on the way to this node
+            bool mDone = false;      // Interrupted, or nothing smaller than the incumbent exists
+
+            bool shouldStop() {
+                if (mDone) return true;
+                if ((stats.nodes & 255) != 0) return false;
+
+                if (mControl.nodeCounter) *mControl.nodeCounter += 256;
+                if (mControl.sharedBest) {
+                    bestSize = min(bestSize, mControl.sharedBest->load(memory_order_relaxed));
+                    if (bestSize <= mControl.knownLowerBound) mDone = true;
+                }
+                if ((mControl.cancel && mControl.cancel->load(memory_order_relaxed)) ||
+                    (mControl.deadline != chrono::steady_clock::time_point::max() &&
+                     chrono::steady_clock::now() >= mControl.deadline)) {
+                    stats.interrupted = true;
+                    mDone = true;
+                }
+                return mDone;
+            }
+
+            void take(CityId city, CityBitset& live, CityBitset& covered) {
+                mChosen.push_back(city);
+                live.reset(city);
+                covered |= mClosed[city];
+            }
+
+            /* Applies the reduction rules until none applies. Returns false if some
+             * city can no longer be covered.
+             */
+            bool reduce(CityBitset& live, CityBitset& covered) {
+                for (bool changed = true; changed; ) {
+                    changed = false;
+
+                    /* A set inside another set is never needed. Of two equal sets, the
+                     * one with the larger id goes.
+                     */
+                    live.forEach([&](CityId city) {
+                        if (!live.test(city)) return;
+
+                        /* Any superset covers the set's first city too, so only the
+                         * sets that cover that city need checking.
+                         */
+                        CityBitset set = mClosed[city];
+                        set.andNot(covered);
+                        int first = set.firstSet();
+                        if (first == -1) {
+                            live.reset(city);
+                            return;
+                        }
+
+                        CityBitset others = mClosed[first];
+                        others &= live;
+                        bool dominated = false;
+                        others.forEach([&](CityId other) {
+                            if (dominated || other == city || !mClosed[city].isSubsetOf(mClosed[other], covered)) return;
+                            if (other > city && mClosed[other].isSubsetOf(mClosed[city], covered)) return;
+                            dominated = true;
+                        });
+                        if (dominated) {
+                            live.reset(city);
+                            stats.dominated++;
+                        }
+                    });
+
+                    /* A city only one set covers needs that set. */
+                    bool stuck = false;
+                    uncoveredCities(covered).forEach([&](CityId city) {
+                        if (stuck || covered.test(city)) return;
+
+                        CityBitset choices = mClosed[city];
+                        choices &= live;
+                        int count = choices.count();
+                        if (count == 0) {
+                            stuck = true;
+                        } else if (count == 1) {
+                            take(CityId(choices.firstSet()), live, covered);
+                            stats.forced++;
+                            changed = true;
+                        }
+                    });
+                    if (stuck) return false;
+                }
+                return true;
+            }
+
+            static CityBitset uncoveredCities(const CityBitset& covered) {
+                CityBitset result = covered;
+                result.setAll();
+                result.andNot(covered);
+                return result;
+            }
+
+            void record() {
+                if (int(mChosen.size()) >= bestSize) return;
+                bestSize = int(mChosen.size());
+                best = mChosen;
+                found = true;
+                stats.improvements++;
+                publishCover(mControl, best);
+                if (bestSize <= mControl.knownLowerBound) mDone = true;
+            }
+
+            void search(CityBitset live, CityBitset covered) {
+                stats.nodes++;
+                if (shouldStop()) return;
+
+                size_t depth = mChosen.size();
+                if (!reduce(live, covered)) {
+                    mChosen.resize(depth);
+                    return;
+                }
+
+                int uncovered = covered.size() - covered.count();
+                if (uncovered == 0) {
+                    record();
+                    mChosen.resize(depth);
+                    return;
+                }
+
+                /* Branch on the largest set; among those, the one whose cities are
+                 * hardest to cover otherwise, since taking it shrinks the measure most.
+                 */
+                int largest = 0, largestSize = 0;
+                long long largestFrequency = 0;
+                live.forEach([&](CityId city) {
+                    int size = mClosed[city].countAndNot(covered);
+                    if (size < largestSize) return;
+
+                    long long frequency = 0;
+                    mClosed[city].forEach([&](CityId near) {
+                        if (!covered.test(near)) frequency += mClosed[near].countAnd(live);
+                    });
+                    if (size > largestSize || frequency < largestFrequency) {
+                        largest = int(city);
+                        largestSize = size;
+                        largestFrequency = frequency;
+                    }
+                });
+
+                /* Each set covers at most largestSize more cities. */
+                int needed = (uncovered + largestSize - 1) / largestSize;
+                if (int(mChosen.size()) + needed >= bestSize) {
+                    stats.boundPrunes++;
+                } else if (largestSize <= 2) {
+                    edgeCover(live, covered);
+                    record();
+                } else {
+                    CityBitset taken = live, coveredAfter = covered;
+                    take(CityId(largest), taken, coveredAfter);
+                    search(taken, coveredAfter);
+                    mChosen.pop_back();
+
+                    live.reset(CityId(largest));
+                    search(live, covered);
+                }
+                mChosen.resize(depth);
+            }
+
+            /* Every set covers exactly two cities: after the reductions, smaller sets
+             * are gone. The sets are then the edges of a graph on the uncovered cities,
+             * and a smallest cover is a maximum matching plus one set for each city the
+             * matching misses.
+             */
+            void edgeCover(const CityBitset& live, const CityBitset& covered) {
+                vector<int> index(covered.size(), -1);
+                int numCities = 0;
+                uncoveredCities(covered).forEach([&](CityId city) {
+                    index[city] = numCities++;
+                });
+
+                vector<pair<int, int>> edges;
+                vector<CityId> edgeSets;
+                live.forEach([&](CityId city) {
+                    CityBitset set = mClosed[city];
+                    set.andNot(covered);
+                    int first = set.firstSet();
+                    edges.emplace_back(index[first], index[set.nextSet(first + 1)]);
+                    edgeSets.push_back(city);
+                });
+
+                /* No two unmatched cities share a set, or the matching could grow. */
+                BlossomMatching matching(numCities, edges);
+                vector<char> done(numCities, false);
+                for (size_t i = 0; i < edges.size(); i++) {
+                    auto [from, to] = edges[i];
+                    if (matching.mate(from) == to) mChosen.push_back(edgeSets[i]);
+                }
+                for (size_t i = 0; i < edges.size(); i++) {
+                    for (int city: { edges[i].first, edges[i].second }) {
+                        if (matching.mate(city) == -1 && !done[city]) {
+                            mChosen.push_back(edgeSets[i]);
+                            done[city] = true;
+                        }
+                    }
+                }
+            }
+        };
+    }
+
+    bool measureAndConquerCover(const CoverProblem& problem, vector<CityId>& cover,
+                                SearchStats* stats, const SearchControl& control) {
+        if (!greedySupplyCover(problem, cover)) {
+            if (stats) *stats = SearchStats();
+            return false;
+        }
+
+        bool haveIncumbent = int(cover.size()) <= control.upperLimit;
+        if (haveIncumbent) publishCover(control, cover);
+        if (haveIncumbent && int(cover.size()) <= control.knownLowerBound) {
+            if (stats) *stats = SearchStats();
+            return true;
+        }
+
+        MeasureConquer search(problem, haveIncumbent? int(cover.size()) : control.upperLimit + 1, control);
+        search.run();
+        if (search.found) {
+            cover = search.best;
+            sort(cover.begin(), cover.end());
+            haveIncumbent = true;
+        }
+
+        if (stats) *stats = search.stats;
+        return haveIncumbent;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("measureAndConquerCover agrees with branch and bound on random networks.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(161);
+    for (int trial = 0; trial < 200; trial++) {
+        CoverProblem problem = randomProblem(generator, 30, 45);
+
+        std::vector<CityId> expected, cover;
+        bool feasible = findMinimumSupplyCover(problem, expected);
+        EXPECT_EQUAL(measureAndConquerCover(problem, cover), feasible);
+        if (!feasible) continue;
+        EXPECT_EQUAL(cover.size(), expected.size());
+
+        EXPECT(isValidCover(problem, cover));
+    }
+}
+
+STUDENT_TEST("Sets of two cities are finished off by matching, blossoms and all.") {
+    using namespace Disaster;
+
+    /* The Petersen graph's cities must be covered but can't hold supplies. Each of
+     * its roads gets a midpoint that can hold supplies and covers both ends. The
+     * smallest cover is a perfect matching, which needs blossoms to find.
+     */
+    std::vector<std::pair<CityId, CityId>> petersen = {
+        { 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 4 }, { 4, 0 },
+        { 0, 5 }, { 1, 6 }, { 2, 7 }, { 3, 8 }, { 4, 9 },
+        { 5, 7 }, { 7, 9 }, { 9, 6 }, { 6, 8 }, { 8, 5 }
+    };
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int i = 0; i < 10; i++) names.push_back(std::to_string(i));
+    for (auto [from, to]: petersen) {
+        CityId midpoint = CityId(names.size());
+        names.push_back(std::to_string(from) + "-" + std::to_string(to));
+        roads.emplace_back(from, midpoint);
+        roads.emplace_back(midpoint, to);
+    }
+
+    CoverProblem problem{RoadGraph(names, roads)};
+    for (CityId city = 0; city < 10; city++) problem.allowed.reset(city);
+    for (CityId city = 10; city < CityId(names.size()); city++) problem.mustCover.reset(city);
+
+    std::vector<CityId> cover;
+    SearchStats stats;
+    EXPECT(measureAndConquerCover(problem, cover, &stats));
+    EXPECT_EQUAL(cover.size(), 5);
+    EXPECT_EQUAL(stats.nodes, 1);
+}
+
+STUDENT_TEST("Measure and conquer visits fewer nodes than branch and bound on dense networks.") {
+    using namespace Disaster;
+
+    /* Random networks where each road is present with probability 30%. */
+    std::mt19937 generator(577);
+    for (int numCities: { 40, 60, 80 }) {
+        CoverProblem problem{randomNetwork(generator, numCities, 30)};
+
+        SearchStats branching, measured;
+        std::vector<CityId> expected, cover;
+        EXPECT(findMinimumSupplyCover(problem, expected, &branching));
+        EXPECT(measureAndConquerCover(problem, cover, &measured));
+        EXPECT_EQUAL(cover.size(), expected.size());
+        EXPECT_LESS_THAN(measured.nodes, branching.nodes);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include <vector>
+
+namespace Disaster {
+    /**
+     * Finds a smallest cover with the set-cover algorithm of Fomin, Grandoni, and
+     * Kratsch, whose running time measure-and-conquer analysis bounds by O(1.52^n).
+     * <p>
+     * Each allowed city is a set: the cities in its closed neighborhood that still
+     * need covering. Before branching, sets contained in other sets are discarded,
+     * and a city only one set can cover forces that set into the cover. Then the
+     * largest set is either taken or discarded. Once no set has more than two
+     * cities, the rest is a minimum edge cover, which a maximum matching solves in
+     * polynomial time. Unlike the branch-and-bound search, which branches on the
+     * cities to cover, this branches on the suppliers, so it does best on dense
+     * networks where each supplier covers a lot.
+     * <p>
+     * The search starts from a greedy cover and prunes subtrees that can't beat it.
+     * The stats count discarded subsets as dominated and forced sets as forced.
+     *
+     * @param problem The instance to solve.
+     * @param cover   An outparameter filled in with a minimum-size cover, if any exists.
+     * @param stats   If non-null, receives counters describing the search.
+     * @param control Optional size limit, cancellation flag, and deadline. The search
+     *                always runs on one thread without a transposition table.
+     * @return Whether any cover within the size limit exists. If interrupted, the cover
+     *         is the best one found so far, which may not be minimum.
+     */
+    bool measureAndConquerCover(const CoverProblem& problem, std::vector<CityId>& cover,
+                                SearchStats* stats = nullptr, const SearchControl& control = {});
+}
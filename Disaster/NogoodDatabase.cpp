@@ -0,0 +1,149 @@
+#include "NogoodDatabase.h"
+#include <algorithm>
+#include <numeric>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* Whether every city in lhs is in rhs. */
+        bool isSubset(const uint64_t* lhs, const uint64_t* rhs, int numWords) {
+            for (int w = 0; w < numWords; w++) {
+                if (lhs[w] & ~rhs[w]) return false;
+            }
+            return true;
+        }
+    }
+
+    NogoodDatabase::NogoodDatabase(int capacity, int numCities)
+        : mCapacity(max(1, capacity)),
+          mNumWords(CityBitset(numCities).numWords()) {
+    }
+
+    bool NogoodDatabase::find(const CityBitset& covered, int budget, Nogood& core) {
+        const uint64_t* coveredWords = covered.words();
+        for (int i = 0; i < size(); i++) {
+            if (mBudgets[i] < budget) continue;
+
+            const uint64_t* words = wordsOf(i);
+            bool uncovered = true;
+            for (int w = 0; w < mNumWords && uncovered; w++) {
+                uncovered = !(words[w] & coveredWords[w]);
+            }
+            if (!uncovered) continue;
+
+            copy(words, words + mNumWords, core.cities.words());
+            core.budget = mBudgets[i];
+            mUses[i]++;
+            mHits++;
+            return true;
+        }
+        mMisses++;
+        return false;
+    }
+
+    /* One core subsumes another if it has a subset of the cities and at least the
+     * budget: it proves everything the other does.
+     */
+    void NogoodDatabase::store(const Nogood& nogood) {
+        const uint64_t* words = nogood.cities.words();
+        for (int i = 0; i < size(); i++) {
+            if (mBudgets[i] >= nogood.budget && isSubset(wordsOf(i), words, mNumWords)) return;
+        }
+
+        retain([&](int i) {
+            return !(nogood.budget >= mBudgets[i] && isSubset(words, wordsOf(i), mNumWords));
+        });
+        if (size() >= mCapacity) evict();
+
+        mWords.insert(mWords.end(), words, words + mNumWords);
+        mBudgets.push_back(nogood.budget);
+        mUses.push_back(0);
+        mStores++;
+    }
+
+    template <typename Predicate> void NogoodDatabase::retain(Predicate keep) {
+        int kept = 0;
+        for (int i = 0; i < size(); i++) {
+            if (!keep(i)) continue;
+            if (kept != i) {
+                copy(wordsOf(i), wordsOf(i) + mNumWords, mWords.begin() + size_t(kept) * mNumWords);
+                mBudgets[kept] = mBudgets[i];
+                mUses[kept] = mUses[i];
+            }
+            kept++;
+        }
+        mWords.resize(size_t(kept) * mNumWords);
+        mBudgets.resize(kept);
+        mUses.resize(kept);
+    }
+
+    /* Keeps the more often used half, oldest first among equals, and starts their
+     * counts over so that cores that were useful long ago eventually make room.
+     */
+    void NogoodDatabase::evict() {
+        vector<int> order(size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int lhs, int rhs) {
+            return mUses[lhs] > mUses[rhs];
+        });
+
+        vector<char> keep(size(), false);
+        for (int i = 0; i < size() / 2; i++) keep[order[i]] = true;
+
+        int before = size();
+        retain([&](int i) {
+            return keep[i];
+        });
+        mEvictions += before - size();
+        for (long long& uses: mUses) uses /= 2;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("NogoodDatabase finds uncovered cores, drops subsumed ones, and evicts when full.") {
+    using namespace Disaster;
+
+    NogoodDatabase database(4, 10);
+    Nogood core{CityBitset(10), 2}, found{CityBitset(10), 0};
+    core.cities.set(1);
+    core.cities.set(2);
+    database.store(core);
+
+    /* Found while cities 1 and 2 are uncovered and the budget is at most 2. */
+    CityBitset covered(10);
+    covered.set(5);
+    EXPECT(database.find(covered, 2, found));
+    EXPECT(found.cities == core.cities);
+    EXPECT_EQUAL(found.budget, 2);
+    EXPECT(!database.find(covered, 3, found));
+    covered.set(2);
+    EXPECT(!database.find(covered, 1, found));
+    EXPECT_EQUAL(database.hits(), 1);
+    EXPECT_EQUAL(database.misses(), 2);
+
+    /* A superset with a smaller budget adds nothing... */
+    Nogood weaker = core;
+    weaker.cities.set(3);
+    weaker.budget = 1;
+    database.store(weaker);
+    EXPECT_EQUAL(database.size(), 1);
+
+    /* ...and a subset with a larger budget replaces what it subsumes. */
+    Nogood stronger{CityBitset(10), 3};
+    stronger.cities.set(1);
+    database.store(stronger);
+    EXPECT_EQUAL(database.size(), 1);
+    EXPECT_EQUAL(database.stores(), 2);
+
+    /* Overfilling makes room by evicting half. */
+    for (CityId city = 4; city < 10; city++) {
+        Nogood single{CityBitset(10), 1};
+        single.cities.set(city);
+        database.store(single);
+    }
+    EXPECT_LESS_THAN_OR_EQUAL_TO(database.size(), 4);
+    EXPECT_GREATER_THAN(database.evictions(), 0);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CityBitset.h"
+#include <cstdint>
+#include <vector>
+
+namespace Disaster {
+    /* A set of cities that can't all be covered by budget or fewer supplies. */
+    struct Nogood {
+        CityBitset cities;
+        int budget = 0;
+    };
+
+    /**
+     * A bounded store of nogoods learned by the search. Each nogood is a core: a set of
+     * cities that can't all be covered by budget or fewer supplies, even using every
+     * city the problem allows. Unlike a transposition table entry, a core doesn't
+     * depend on the rest of the state, so it prunes any later node where the whole
+     * core is still uncovered and the remaining budget is no larger.
+     * <p>
+     * A core is redundant if another core with a subset of its cities proves at least
+     * as much, so storing a core drops those it subsumes and skips it if it's already
+     * subsumed. When the store is full, the less useful half goes, as in a SAT
+     * solver's clause database. Each search worker owns its own store, so nothing
+     * here is locked. Lookups scan every core, so the cores' words sit side by side
+     * in one array rather than in bitsets of their own.
+     */
+    class NogoodDatabase {
+    public:
+        /* Creates a database holding at most the given number of cores, each a set of
+         * cities out of numCities.
+         */
+        NogoodDatabase(int capacity, int numCities);
+
+        /* Looks for a stored core none of whose cities are covered and whose budget is
+         * at least the given one. If there is one, copies it into core.
+         */
+        bool find(const CityBitset& covered, int budget, Nogood& core);
+
+        /* Records a core, unless a stored core already proves as much. */
+        void store(const Nogood& nogood);
+
+        int capacity() const {
+            return mCapacity;
+        }
+        int size() const {
+            return int(mBudgets.size());
+        }
+
+        long long hits()      const { return mHits; }
+        long long misses()    const { return mMisses; }
+        long long stores()    const { return mStores; }
+        long long evictions() const { return mEvictions; }
+
+    private:
+        int mCapacity;
+        int mNumWords;                      // Words per core
+        std::vector<std::uint64_t> mWords;  // Each core's cities, mNumWords apiece
+        std::vector<int> mBudgets;
+        std::vector<long long> mUses;       // Hits since the last eviction, which decides who stays
+        long long mHits = 0, mMisses = 0, mStores = 0, mEvictions = 0;
+
+        const std::uint64_t* wordsOf(int index) const {
+            return mWords.data() + std::size_t(index) * mNumWords;
+        }
+
+        /* Keeps only the cores for which keep(index) is true, in order. */
+        template <typename Predicate> void retain(Predicate keep);
+        void evict();
+    };
+}
@@ -0,0 +1,104 @@
+#include "Resilience.h"
+#include "ThreadPool.h"
+#include <future>
+using namespace std;
+
+namespace Disaster {
+    vector<RoadFailure> roadFailures(const RoadGraph& graph, const SolverOptions& options) {
+        vector<CityId> base = findMinimumCover(graph, options);
+
+        /* How many cover cities supply each city. */
+        vector<bool> inCover(graph.numCities(), false);
+        vector<int> suppliers(graph.numCities(), 0);
+        for (CityId city: base) {
+            inCover[city] = true;
+            suppliers[city]++;
+            for (CityId neighbor: graph.neighbors(city)) suppliers[neighbor]++;
+        }
+
+        /* Cutting the road strands city if the other end was its only supplier. */
+        auto strands = [&](CityId city, CityId other) {
+            return !inCover[city] && inCover[other] && suppliers[city] == 1;
+        };
+
+        vector<string> names;
+        vector<pair<CityId, CityId>> roads;
+        for (CityId city = 0; city < CityId(graph.numCities()); city++) {
+            names.push_back(graph.nameOf(city));
+            for (CityId neighbor: graph.neighbors(city)) {
+                if (city < neighbor) roads.emplace_back(city, neighbor);
+            }
+        }
+
+        SolverOptions single = options;
+        single.threads = 1;
+
+        vector<RoadFailure> result(roads.size());
+        ThreadPool pool(options.threads);
+        vector<future<void>> pending;
+        for (size_t i = 0; i < roads.size(); i++) {
+            RoadFailure& failure = result[i];
+            failure.from = roads[i].first;
+            failure.to   = roads[i].second;
+            failure.cover = base;
+
+            bool fromStranded = strands(failure.from, failure.to);
+            if (!fromStranded && !strands(failure.to, failure.from)) continue;
+            CityId stranded = fromStranded? failure.from : failure.to;
+
+            /* The repaired cover is one city too many unless a search finds better. */
+            pending.push_back(pool.submit([&, i, stranded] {
+                vector<pair<CityId, CityId>> remaining = roads;
+                remaining.erase(remaining.begin() + i);
+                RoadGraph cut(names, remaining);
+
+                RoadFailure& failure = result[i];
+                vector<CityId> cover;
+                if (findCoverWithin(cut, int(base.size()), cover, single)) {
+                    failure.cover = cover;
+                    failure.impact = FailureImpact::REPLANNED;
+                } else {
+                    failure.cover.push_back(stranded);
+                    failure.impact = FailureImpact::GREW;
+                }
+            }));
+        }
+        for (auto& task: pending) task.get();
+
+        return result;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("roadFailures matches solving every cut network from scratch.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(24);
+    for (int round = 0; round < 40; round++) {
+        RoadGraph graph = randomProblem(generator, 15).graph;
+        int minimum = int(findMinimumCover(graph).size());
+
+        auto failures = roadFailures(graph);
+        EXPECT_EQUAL(int(failures.size()), graph.numRoads());
+        std::vector<std::string> names;
+        for (CityId city = 0; city < CityId(graph.numCities()); city++) names.push_back(graph.nameOf(city));
+        for (const auto& failure: failures) {
+            std::vector<std::pair<CityId, CityId>> remaining;
+            for (CityId city = 0; city < CityId(graph.numCities()); city++) {
+                for (CityId near: graph.neighbors(city)) {
+                    if (city < near && std::make_pair(city, near) != std::make_pair(failure.from, failure.to)) {
+                        remaining.emplace_back(city, near);
+                    }
+                }
+            }
+            RoadGraph cut(names, remaining);
+            EXPECT_EQUAL(failure.cover.size(), findMinimumCover(cut).size());
+            EXPECT_EQUAL(int(failure.cover.size()), minimum + (failure.impact == FailureImpact::GREW? 1 : 0));
+            EXPECT(isValidCover(CoverProblem(cut), failure.cover));
+        }
+    }
+}
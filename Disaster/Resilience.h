@@ -0,0 +1,39 @@
+#pragma once
+
+#include "RoadGraph.h"
+#include "Solver.h"
+#include <vector>
+
+namespace Disaster {
+    /* How cutting one road changed the smallest cover. */
+    enum class FailureImpact {
+        UNCHANGED,  // The old cover still covers everything
+        REPLANNED,  // The old cover doesn't, but a different cover just as small does
+        GREW        // Every cover needs one more city
+    };
+
+    /* A smallest cover of the network with one road cut. */
+    struct RoadFailure {
+        CityId from = 0, to = 0;    // The cut road, with from < to
+        std::vector<CityId> cover;  // A smallest cover without that road
+        FailureImpact impact = FailureImpact::UNCHANGED;
+    };
+
+    /**
+     * For every road, finds a smallest cover of the network with just that road cut.
+     * <p>
+     * Every answer starts from one minimum cover of the whole network. A cover of the
+     * cut network covers the whole one too, so cutting a road never lowers the
+     * minimum. The only city a cut can strand is an endpoint outside the cover that
+     * relied on the other endpoint alone, and adding it back repairs the cover. So
+     * each new minimum is the old one or one more, and telling which takes at most
+     * one decision search at the old size. Most cuts strand nothing and need no
+     * search at all. The searches for different roads run in parallel.
+     *
+     * @param graph   The road network.
+     * @param options Solver settings. The threads go to solving the roads side by
+     *                side, so each cut network is solved on one thread.
+     * @return One entry per road, ordered by from and then to.
+     */
+    std::vector<RoadFailure> roadFailures(const RoadGraph& graph, const SolverOptions& options = {});
+}
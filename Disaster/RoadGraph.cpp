@@ -0,0 +1,164 @@
+#include "RoadGraph.h"
+#include "error.h"
+#include <algorithm>
+using namespace std;
+
+namespace Disaster {
+    RoadGraph::RoadGraph(const Map<string, Set<string>>& roadNetwork) {
+        /* Collect every city name. Map and Set iterate in sorted order, so merging the
+         * keys with the neighbor names keeps ids sorted by name.
+         */
+        Set<string> allCities;
+        for (const string& city: roadNetwork) {
+            allCities += city;
+            for (const string& neighbor: roadNetwork[city]) {
+                allCities += neighbor;
+            }
+        }
+        for (const string& city: allCities) {
+            mNames.push_back(city);
+        }
+        buildIndex();
+
+        vector<pair<CityId, CityId>> roads;
+        for (const string& city: roadNetwork) {
+            CityId from = mIndex.at(city);
+            for (const string& neighbor: roadNetwork[city]) {
+                roads.emplace_back(from, mIndex.at(neighbor));
+            }
+        }
+
+        *this = RoadGraph(std::move(mNames), roads);
+    }
+
+    RoadGraph::RoadGraph(vector<string> names, const vector<pair<CityId, CityId>>& roads)
+        : mNames(std::move(names)) {
+        buildIndex();
+
+        /* Symmetrize, then sort and deduplicate so each adjacency list is sorted. */
+        vector<pair<CityId, CityId>> arcs;
+        arcs.reserve(2 * roads.size());
+        for (const auto& road: roads) {
+            if (road.first >= mNames.size() || road.second >= mNames.size()) {
+                error("Road refers to a city that doesn't exist.");
+            }
+            if (road.first == road.second) continue;
+
+            arcs.emplace_back(road.first, road.second);
+            arcs.emplace_back(road.second, road.first);
+        }
+        sort(arcs.begin(), arcs.end());
+        arcs.erase(unique(arcs.begin(), arcs.end()), arcs.end());
+
+        /* Counting pass followed by a fill pass gives the CSR arrays. */
+        mOffsets.assign(mNames.size() + 1, 0);
+        for (const auto& arc: arcs) {
+            mOffsets[arc.first + 1]++;
+        }
+        for (size_t i = 0; i < mNames.size(); i++) {
+            mOffsets[i + 1] += mOffsets[i];
+            mMaxDegree = max(mMaxDegree, int(mOffsets[i + 1] - mOffsets[i]));
+        }
+
+        mTargets.reserve(arcs.size());
+        for (const auto& arc: arcs) {
+            mTargets.push_back(arc.second);
+        }
+    }
+
+    void RoadGraph::buildIndex() {
+        mIndex.clear();
+        for (size_t i = 0; i < mNames.size(); i++) {
+            if (!mIndex.emplace(mNames[i], CityId(i)).second) {
+                error("Duplicate city name: " + mNames[i]);
+            }
+        }
+    }
+
+    bool RoadGraph::isAdjacent(CityId from, CityId to) const {
+        auto range = neighbors(from);
+        return binary_search(range.begin(), range.end(), to);
+    }
+
+    CityId RoadGraph::idOf(const string& name) const {
+        auto itr = mIndex.find(name);
+        if (itr == mIndex.end()) {
+            error("Unknown city: " + name);
+        }
+        return itr->second;
+    }
+
+    bool RoadGraph::contains(const string& name) const {
+        return mIndex.count(name);
+    }
+
+    Set<string> RoadGraph::namesOf(const vector<CityId>& cities) const {
+        Set<string> result;
+        for (CityId city: cities) {
+            result += mNames[city];
+        }
+        return result;
+    }
+
+    RoadGraph RoadGraph::induced(const vector<CityId>& cities) const {
+        vector<CityId> renumber(mNames.size(), CityId(-1));
+        vector<string> names;
+        for (CityId city: cities) {
+            renumber[city] = CityId(names.size());
+            names.push_back(mNames[city]);
+        }
+
+        vector<pair<CityId, CityId>> roads;
+        for (CityId city: cities) {
+            for (CityId neighbor: neighbors(city)) {
+                if (renumber[neighbor] != CityId(-1) && city < neighbor) {
+                    roads.emplace_back(renumber[city], renumber[neighbor]);
+                }
+            }
+        }
+        return RoadGraph(std::move(names), roads);
+    }
+
+    Map<string, Set<string>> RoadGraph::toMap() const {
+        Map<string, Set<string>> result;
+        for (CityId city = 0; city < mNames.size(); city++) {
+            result[mNames[city]];
+            for (CityId neighbor: neighbors(city)) {
+                result[mNames[city]] += mNames[neighbor];
+            }
+        }
+        return result;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("RoadGraph interns cities in sorted order and symmetrizes roads.") {
+    Map<std::string, Set<std::string>> network = {
+        { "Carmel",  { "Alameda" } },
+        { "Alameda", { "Berkeley" } },
+    };
+
+    Disaster::RoadGraph graph(network);
+    EXPECT_EQUAL(graph.numCities(), 3);
+    EXPECT_EQUAL(graph.numRoads(), 2);
+    EXPECT_EQUAL(graph.nameOf(0), "Alameda");
+    EXPECT_EQUAL(graph.nameOf(1), "Berkeley");
+    EXPECT_EQUAL(graph.nameOf(2), "Carmel");
+
+    EXPECT_EQUAL(graph.degree(graph.idOf("Alameda")), 2);
+    EXPECT_EQUAL(graph.degree(graph.idOf("Berkeley")), 1);
+    EXPECT(graph.isAdjacent(graph.idOf("Berkeley"), graph.idOf("Alameda")));
+    EXPECT(!graph.isAdjacent(graph.idOf("Berkeley"), graph.idOf("Carmel")));
+    EXPECT_EQUAL(graph.maxDegree(), 2);
+}
+
+STUDENT_TEST("RoadGraph ignores duplicate roads and self-loops.") {
+    Disaster::RoadGraph graph({ "A", "B" }, { { 0, 1 }, { 1, 0 }, { 0, 0 } });
+    EXPECT_EQUAL(graph.numRoads(), 1);
+    EXPECT_EQUAL(graph.degree(0), 1);
+    EXPECT_EQUAL(graph.toMap(), Map<std::string, Set<std::string>>({ { "A", { "B" } }, { "B", { "A" } } }));
+    EXPECT_ERROR(graph.idOf("C"));
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "map.h"
+#include "set.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Disaster {
+    /* Cities are interned to dense integer ids in [0, numCities()). */
+    using CityId = std::uint32_t;
+
+    /**
+     * An immutable, integer-indexed view of a road network. Each city is assigned a
+     * dense id (in sorted order of the city names when built from a Map), and the
+     * adjacency lists are stored in compressed sparse row (CSR) form: the neighbors
+     * of city c are targets[offsets[c]] through targets[offsets[c + 1] - 1], sorted
+     * in increasing order.
+     * <p>
+     * The graph is built once at the API boundary so that the search itself never
+     * touches a string or walks a tree-based container.
+     */
+    class RoadGraph {
+    public:
+        /* A contiguous run of neighbor ids, usable in a range-based for loop. */
+        struct Neighbors {
+            const CityId* first;
+            const CityId* last;
+
+            const CityId* begin() const { return first; }
+            const CityId* end()   const { return last;  }
+            int size() const { return int(last - first); }
+        };
+
+        RoadGraph() = default;
+
+        /**
+         * Builds the graph from a road network. Every city mentioned anywhere in the
+         * network becomes a vertex, and roads are treated as bidirectional even if
+         * the network only lists them in one direction. Self-loops are ignored.
+         */
+        explicit RoadGraph(const Map<std::string, Set<std::string>>& roadNetwork);
+
+        /**
+         * Builds the graph from a list of city names and a list of roads between
+         * their indices. Duplicate roads and self-loops are ignored.
+         */
+        RoadGraph(std::vector<std::string> names,
+                  const std::vector<std::pair<CityId, CityId>>& roads);
+
+        int numCities() const {
+            return int(mNames.size());
+        }
+
+        /* Number of undirected roads. */
+        int numRoads() const {
+            return int(mTargets.size() / 2);
+        }
+
+        int degree(CityId city) const {
+            return int(mOffsets[city + 1] - mOffsets[city]);
+        }
+
+        int maxDegree() const {
+            return mMaxDegree;
+        }
+
+        Neighbors neighbors(CityId city) const {
+            return { mTargets.data() + mOffsets[city], mTargets.data() + mOffsets[city + 1] };
+        }
+
+        /* Whether there's a road between the two cities. */
+        bool isAdjacent(CityId from, CityId to) const;
+
+        const std::string& nameOf(CityId city) const {
+            return mNames[city];
+        }
+
+        /* Looks up a city's id, reporting an error if there's no such city. */
+        CityId idOf(const std::string& name) const;
+
+        /* Whether the named city is in the graph. */
+        bool contains(const std::string& name) const;
+
+        /* Translates a list of city ids back into city names. */
+        Set<std::string> namesOf(const std::vector<CityId>& cities) const;
+
+        /* The subgraph induced by the given cities. City i of the result is cities[i]. */
+        RoadGraph induced(const std::vector<CityId>& cities) const;
+
+        /* Converts the graph back into the Map representation used by the public API. */
+        Map<std::string, Set<std::string>> toMap() const;
+
+    private:
+        std::vector<std::string> mNames;
+        std::unordered_map<std::string, CityId> mIndex;
+        std::vector<std::uint32_t> mOffsets{0};
+        std::vector<CityId> mTargets;
+        int mMaxDegree = 0;
+
+        void buildIndex();
+    };
+}
@@ -0,0 +1,206 @@
+#include "SatCover.h"
+#include "error.h"
+#include <algorithm>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* The problem as CNF, with a budget that can be lowered between solves.
+         *
+         * Each allowed city gets a variable saying whether it holds supplies, and each
+         * city that must be covered gets a clause asking for supplies somewhere in its
+         * closed neighborhood. Counting uses Sinz's sequential counter: register (i, j)
+         * is forced true once j + 1 of the first i + 1 cities hold supplies. The
+         * registers of the last row then count everything, so capping the budget at k
+         * is the single unit clause "not (k + 1 supplies)". Lowering the budget only
+         * ever adds clauses, so whatever the solver learned earlier stays valid.
+         */
+        class CoverEncoding {
+        public:
+            /* Builds registers for budgets up to maxBudget. */
+            CoverEncoding(const CoverProblem& problem, int maxBudget) {
+                vector<int> variableOf(problem.graph.numCities(), -1);
+                problem.allowed.forEach([&](CityId city) {
+                    variableOf[city] = mSolver.newVariable();
+                    mSupplies.push_back(variableOf[city]);
+                    mCities.push_back(city);
+                });
+
+                problem.mustCover.forEach([&](CityId city) {
+                    vector<Literal> clause;
+                    if (variableOf[city] != -1) clause.push_back(positive(variableOf[city]));
+                    for (CityId near: problem.graph.neighbors(city)) {
+                        if (variableOf[near] != -1) clause.push_back(positive(variableOf[near]));
+                    }
+                    mSolver.addClause(clause);
+                });
+
+                /* Counting past maxBudget + 1 is pointless, as is counting past n. */
+                int n = int(mSupplies.size());
+                int width = min(maxBudget, n - 1) + 1;
+                mCount.assign(n, vector<int>(width));
+                for (auto& row: mCount) {
+                    for (int& variable: row) variable = mSolver.newVariable();
+                }
+
+                for (int i = 0; i < n && width > 0; i++) {
+                    mSolver.addClause({ negative(mSupplies[i]), positive(mCount[i][0]) });
+                    if (i == 0) {
+                        for (int j = 1; j < width; j++) mSolver.addClause({ negative(mCount[0][j]) });
+                        continue;
+                    }
+                    for (int j = 0; j < width; j++) {
+                        mSolver.addClause({ negative(mCount[i - 1][j]), positive(mCount[i][j]) });
+                        if (j > 0) {
+                            mSolver.addClause({ negative(mSupplies[i]), negative(mCount[i - 1][j - 1]),
+                                                positive(mCount[i][j]) });
+                        }
+                    }
+                }
+            }
+
+            /* Allows at most budget supplies from now on. Budgets may only go down. */
+            void limit(int budget) {
+                if (mCount.empty() || budget >= int(mCount.back().size())) return;
+                mSolver.addClause({ negative(mCount.back()[budget]) });
+            }
+
+            bool solve(const SearchControl& control, vector<CityId>& cover) {
+                SatControl limits;
+                limits.cancel = control.cancel;
+                limits.deadline = control.deadline;
+                limits.conflictCounter = control.nodeCounter;
+                if (mSolver.solve(limits) != SatResult::SATISFIABLE) return false;
+
+                cover.clear();
+                for (size_t i = 0; i < mCities.size(); i++) {
+                    if (mSolver.value(mSupplies[i])) cover.push_back(mCities[i]);
+                }
+                return true;
+            }
+
+            const SatStats& stats() const {
+                return mSolver.stats;
+            }
+
+        private:
+            SatSolver mSolver;
+            vector<CityId> mCities;        // Allowed cities, in variable order
+            vector<int> mSupplies;         // Whether each of them holds supplies
+            vector<vector<int>> mCount;    // The counter's registers
+        };
+    }
+
+    bool satSupplyCover(const CoverProblem& problem, int budget, vector<CityId>& cover,
+                        SatStats* stats, const SearchControl& control) {
+        if (budget < 0) error("Budget can't be negative.");
+
+        CoverEncoding encoding(problem, budget);
+        encoding.limit(budget);
+        bool found = encoding.solve(control, cover);
+        if (stats) *stats = encoding.stats();
+        return found;
+    }
+
+    bool findMinimumSatCover(const CoverProblem& problem, vector<CityId>& cover,
+                             SatStats* stats, const SearchControl& control) {
+        vector<CityId> best;
+        if (!greedySupplyCover(problem, best)) {
+            if (stats) *stats = SatStats();
+            return false;
+        }
+
+        bool found = int(best.size()) <= control.upperLimit;
+        int budget = found? int(best.size()) - 1 : control.upperLimit;
+        int bound = max(lowerBoundOnCover(problem), control.knownLowerBound);
+        if (found) publishCover(control, best);
+        if (control.sharedBest) budget = min(budget, control.sharedBest->load() - 1);
+        if (budget < bound) {
+            if (found) cover = best;
+            if (stats) *stats = SatStats();
+            return found;
+        }
+
+        /* One solver for every budget: each cover found lowers the cap right away,
+         * and clauses learned at one budget keep pruning at the next.
+         */
+        CoverEncoding encoding(problem, budget);
+        vector<CityId> smaller;
+        while (budget >= bound) {
+            encoding.limit(budget);
+            if (!encoding.solve(control, smaller)) break;
+
+            best = smaller;
+            found = true;
+            publishCover(control, best);
+            budget = int(best.size()) - 1;
+
+            /* Another solver may have found something smaller in the meantime. */
+            if (control.sharedBest) budget = min(budget, control.sharedBest->load() - 1);
+        }
+
+        if (found) cover = best;
+        if (stats) *stats = encoding.stats();
+        return found;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("The SAT backend agrees with branch and bound on random networks.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(16);
+    for (int round = 0; round < 100; round++) {
+        CoverProblem problem = randomProblem(generator, 16);
+
+        std::vector<CityId> expected, cover;
+        bool exists = findMinimumSupplyCover(problem, expected);
+        EXPECT_EQUAL(findMinimumSatCover(problem, cover), exists);
+        if (!exists) continue;
+        EXPECT_EQUAL(cover.size(), expected.size());
+
+        /* The cover really is one, and the budget below it really is infeasible. */
+        EXPECT(isValidCover(problem, cover));
+        if (!cover.empty()) {
+            std::vector<CityId> smaller;
+            EXPECT(!satSupplyCover(problem, int(cover.size()) - 1, smaller));
+        }
+    }
+}
+
+STUDENT_TEST("One SAT solver serves every budget of the minimization.") {
+    using namespace Disaster;
+
+    /* A 7 x 7 grid needs 12 cities. */
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int row = 0; row < 7; row++) {
+        for (int col = 0; col < 7; col++) {
+            CityId id = CityId(names.size());
+            names.push_back(std::to_string(row) + "," + std::to_string(col));
+            if (row > 0) roads.emplace_back(id, id - 7);
+            if (col > 0) roads.emplace_back(id, id - 1);
+        }
+    }
+    CoverProblem grid{RoadGraph(names, roads)};
+
+    std::vector<CityId> cover;
+    SatStats incremental;
+    EXPECT(findMinimumSatCover(grid, cover, &incremental));
+    EXPECT_EQUAL(cover.size(), 12);
+
+    /* Solving each budget from scratch redoes work the single solver keeps. */
+    std::vector<CityId> greedy;
+    EXPECT(greedySupplyCover(grid, greedy));
+    long long separate = 0;
+    for (int budget = int(greedy.size()) - 1; budget >= 11; budget--) {
+        SatStats one;
+        EXPECT_EQUAL(satSupplyCover(grid, budget, cover, &one), budget >= 12);
+        separate += one.conflicts;
+    }
+    EXPECT_LESS_THAN(incremental.conflicts, separate);
+}
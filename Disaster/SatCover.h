@@ -0,0 +1,40 @@
+#pragma once
+
+#include "SatSolver.h"
+#include "SupplySearch.h"
+#include <vector>
+
+namespace Disaster {
+    /**
+     * Decides the problem with the built-in SAT solver instead of branch and bound.
+     * Each allowed city gets a variable saying whether it holds supplies. Each city that
+     * must be covered gets a clause asking for supplies somewhere in its closed
+     * neighborhood. A sequential counter (Sinz's encoding) limits how many variables
+     * can be true.
+     *
+     * @param problem The instance to solve.
+     * @param budget  How many cities may hold supplies. Must be nonnegative.
+     * @param cover   An outparameter filled in with the chosen cities if a cover exists.
+     * @param stats   If non-null, receives counters describing the SAT solve.
+     * @param control Optional cancellation flag and deadline; the rest is ignored.
+     * @return Whether such a set of cities exists. Returns false if interrupted.
+     */
+    bool satSupplyCover(const CoverProblem& problem, int budget, std::vector<CityId>& cover,
+                        SatStats* stats = nullptr, const SearchControl& control = {});
+
+    /**
+     * Finds a smallest cover with the SAT backend: starts from a greedy cover and asks
+     * for one city fewer than the best cover so far until the solver proves that can't
+     * be done, or the lower bound says so without asking. A single solver serves every
+     * budget, so clauses learned along the way keep paying off.
+     *
+     * @param problem The instance to solve.
+     * @param cover   An outparameter filled in with a minimum-size cover, if any exists.
+     * @param stats   If non-null, receives counters summed over the SAT solves.
+     * @param control Optional size limit, cancellation flag, and deadline.
+     * @return Whether any cover within the size limit exists. If interrupted, the cover
+     *         is the best one found so far, which may not be minimum.
+     */
+    bool findMinimumSatCover(const CoverProblem& problem, std::vector<CityId>& cover,
+                             SatStats* stats = nullptr, const SearchControl& control = {});
+}
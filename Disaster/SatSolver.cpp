@@ -0,0 +1,507 @@
+#include "SatSolver.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* Activities decay by inflating the increment instead of shrinking every score. */
+        const double kVariableDecay = 0.95;
+        const double kClauseDecay   = 0.999;
+
+        /* Conflicts in one unit of the Luby restart schedule. */
+        const long long kRestartInterval = 100;
+
+        /* The Luby sequence 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ... */
+        long long luby(int index) {
+            long long size = 1;
+            int power = 0;
+            while (size < index + 1) {
+                power++;
+                size = 2 * size + 1;
+            }
+            while (size - 1 != index) {
+                size = (size - 1) / 2;
+                power--;
+                index = int(index % size);
+            }
+            return 1LL << power;
+        }
+    }
+
+    SatStats& SatStats::operator+= (const SatStats& rhs) {
+        decisions    += rhs.decisions;
+        propagations += rhs.propagations;
+        conflicts    += rhs.conflicts;
+        restarts     += rhs.restarts;
+        deleted      += rhs.deleted;
+        interrupted   = interrupted || rhs.interrupted;
+        return *this;
+    }
+
+    int SatSolver::newVariable() {
+        int variable = numVariables();
+        mAssigns.push_back(0);
+        mLevels.push_back(0);
+        mReasons.push_back(-1);
+        mPolarity.push_back(false);
+        mSeen.push_back(false);
+        mActivity.push_back(0);
+        mHeapIndex.push_back(-1);
+        mWatches.resize(mWatches.size() + 2);
+        heapInsert(variable);
+        return variable;
+    }
+
+    void SatSolver::addClause(vector<Literal> clause) {
+        if (mUnsatisfiable) return;
+
+        /* Drop duplicates and literals already false; skip clauses already satisfied.
+         * After sorting, a literal and its negation sit side by side.
+         */
+        sort(clause.begin(), clause.end());
+        clause.erase(unique(clause.begin(), clause.end()), clause.end());
+        size_t kept = 0;
+        for (size_t i = 0; i < clause.size(); i++) {
+            if (valueOf(clause[i]) > 0) return;
+            if (i + 1 < clause.size() && clause[i + 1] == negation(clause[i])) return;
+            if (valueOf(clause[i]) == 0) clause[kept++] = clause[i];
+        }
+        clause.resize(kept);
+
+        if (clause.empty()) {
+            mUnsatisfiable = true;
+        } else if (clause.size() == 1) {
+            assign(clause[0], -1);
+        } else {
+            store(clause, false);
+        }
+    }
+
+    int SatSolver::store(const vector<Literal>& literals, bool learned) {
+        int index;
+        if (mFreeClauses.empty()) {
+            index = int(mClauses.size());
+            mClauses.emplace_back();
+        } else {
+            index = mFreeClauses.back();
+            mFreeClauses.pop_back();
+        }
+
+        Clause& clause = mClauses[index];
+        clause.literals = literals;
+        clause.learned = learned;
+        clause.activity = 0;
+        mWatches[literals[0]].push_back({ index, literals[1] });
+        mWatches[literals[1]].push_back({ index, literals[0] });
+        return index;
+    }
+
+    void SatSolver::assign(Literal literal, int reason) {
+        int variable = variableOf(literal);
+        mAssigns[variable] = (literal & 1)? -1 : 1;
+        mLevels[variable] = decisionLevel();
+        mReasons[variable] = reason;
+        mTrail.push_back(literal);
+    }
+
+    /* Propagates every pending assignment. Returns a clause that became false, or -1. */
+    int SatSolver::propagate() {
+        while (mHead < mTrail.size()) {
+            Literal falsified = negation(mTrail[mHead++]);
+            stats.propagations++;
+
+            vector<Watch>& watches = mWatches[falsified];
+            size_t kept = 0;
+            for (size_t i = 0; i < watches.size(); i++) {
+                Watch watch = watches[i];
+                if (valueOf(watch.blocker) > 0) {
+                    watches[kept++] = watch;
+                    continue;
+                }
+
+                /* Keep the falsified watch in position 1. */
+                vector<Literal>& literals = mClauses[watch.clause].literals;
+                if (literals[0] == falsified) swap(literals[0], literals[1]);
+                Literal other = literals[0];
+                if (other != watch.blocker && valueOf(other) > 0) {
+                    watches[kept++] = { watch.clause, other };
+                    continue;
+                }
+
+                /* Look for a replacement watch. */
+                bool moved = false;
+                for (size_t j = 2; j < literals.size(); j++) {
+                    if (valueOf(literals[j]) >= 0) {
+                        swap(literals[1], literals[j]);
+                        mWatches[literals[1]].push_back({ watch.clause, other });
+                        moved = true;
+                        break;
+                    }
+                }
+                if (moved) continue;
+
+                /* Everything else is false: the clause is unit or in conflict. */
+                watches[kept++] = { watch.clause, other };
+                if (valueOf(other) < 0) {
+                    for (i++; i < watches.size(); i++) watches[kept++] = watches[i];
+                    watches.resize(kept);
+                    mHead = mTrail.size();
+                    return watch.clause;
+                }
+                assign(other, watch.clause);
+            }
+            watches.resize(kept);
+        }
+        return -1;
+    }
+
+    /* Derives a learned clause from a conflict, leaving it in mLearned with the
+     * asserting literal first and a literal from the backtrack level second. Returns
+     * the level to backtrack to.
+     */
+    int SatSolver::analyze(int conflict) {
+        mLearned.assign(1, 0);
+        int pending = 0;
+        Literal implied = -1;
+        int index = int(mTrail.size()) - 1;
+
+        /* Resolve away current-level literals, latest first, until just one is left. */
+        int reason = conflict;
+        do {
+            Clause& clause = mClauses[reason];
+            if (clause.learned) bumpClause(clause);
+
+            for (Literal literal: clause.literals) {
+                int variable = variableOf(literal);
+                if (literal == implied || mSeen[variable] || mLevels[variable] == 0) continue;
+
+                mSeen[variable] = true;
+                bumpVariable(variable);
+                if (mLevels[variable] == decisionLevel()) {
+                    pending++;
+                } else {
+                    mLearned.push_back(literal);
+                }
+            }
+
+            while (!mSeen[variableOf(mTrail[index])]) index--;
+            implied = mTrail[index--];
+            reason = mReasons[variableOf(implied)];
+            mSeen[variableOf(implied)] = false;
+            pending--;
+        } while (pending > 0);
+        mLearned[0] = negation(implied);
+
+        /* Drop literals whose reasons lie entirely within the clause. */
+        mCollected.assign(mLearned.begin() + 1, mLearned.end());
+        size_t kept = 1;
+        for (size_t i = 1; i < mLearned.size(); i++) {
+            if (!redundant(mLearned[i])) mLearned[kept++] = mLearned[i];
+        }
+        mLearned.resize(kept);
+        for (Literal literal: mCollected) mSeen[variableOf(literal)] = false;
+
+        if (mLearned.size() == 1) return 0;
+
+        size_t deepest = 1;
+        for (size_t i = 2; i < mLearned.size(); i++) {
+            if (mLevels[variableOf(mLearned[i])] > mLevels[variableOf(mLearned[deepest])]) deepest = i;
+        }
+        swap(mLearned[1], mLearned[deepest]);
+        return mLevels[variableOf(mLearned[1])];
+    }
+
+    bool SatSolver::redundant(Literal literal) const {
+        int reason = mReasons[variableOf(literal)];
+        if (reason == -1) return false;
+
+        for (Literal other: mClauses[reason].literals) {
+            int variable = variableOf(other);
+            if (variable != variableOf(literal) && !mSeen[variable] && mLevels[variable] > 0) return false;
+        }
+        return true;
+    }
+
+    void SatSolver::backtrack(int level) {
+        if (decisionLevel() <= level) return;
+
+        for (int i = int(mTrail.size()) - 1; i >= mTrailLimits[level]; i--) {
+            int variable = variableOf(mTrail[i]);
+            mPolarity[variable] = mAssigns[variable] > 0;
+            mAssigns[variable] = 0;
+            mReasons[variable] = -1;
+            heapInsert(variable);
+        }
+        mTrail.resize(mTrailLimits[level]);
+        mTrailLimits.resize(level);
+        mHead = mTrail.size();
+    }
+
+    /* Adds the clause from the last analysis and asserts its first literal. */
+    void SatSolver::learn() {
+        if (mLearned.size() == 1) {
+            assign(mLearned[0], -1);
+            return;
+        }
+
+        int index = store(mLearned, true);
+        bumpClause(mClauses[index]);
+        mNumLearned++;
+        assign(mLearned[0], index);
+    }
+
+    /* Throws out the less active half of the learned clauses. Binary clauses and
+     * clauses that are the reason for a current assignment stay.
+     */
+    void SatSolver::reduceLearned() {
+        vector<int> candidates;
+        for (int i = 0; i < int(mClauses.size()); i++) {
+            const Clause& clause = mClauses[i];
+            if (!clause.learned || clause.literals.size() <= 2) continue;
+
+            Literal first = clause.literals[0];
+            if (valueOf(first) > 0 && mReasons[variableOf(first)] == i) continue;
+            candidates.push_back(i);
+        }
+        sort(candidates.begin(), candidates.end(), [&](int lhs, int rhs) {
+            return mClauses[lhs].activity < mClauses[rhs].activity;
+        });
+        candidates.resize(candidates.size() / 2);
+
+        for (int index: candidates) {
+            vector<Literal>().swap(mClauses[index].literals);
+            mClauses[index].learned = false;
+        }
+        for (auto& watches: mWatches) {
+            watches.erase(remove_if(watches.begin(), watches.end(), [&](const Watch& watch) {
+                return mClauses[watch.clause].literals.empty();
+            }), watches.end());
+        }
+
+        mFreeClauses.insert(mFreeClauses.end(), candidates.begin(), candidates.end());
+        mNumLearned -= int(candidates.size());
+        stats.deleted += int(candidates.size());
+    }
+
+    bool SatSolver::shouldStop(const SatControl& control) {
+        return (control.cancel && control.cancel->load(memory_order_relaxed)) ||
+               (control.deadline != chrono::steady_clock::time_point::max() &&
+                chrono::steady_clock::now() >= control.deadline);
+    }
+
+    /* Runs CDCL until the formula is settled, the conflict limit is reached (a
+     * restart), or the control says to stop.
+     */
+    SatResult SatSolver::search(long long conflictLimit, const SatControl& control, bool& interrupted) {
+        long long conflicts = 0;
+        while (true) {
+            int conflict = propagate();
+            if (conflict != -1) {
+                stats.conflicts++;
+                conflicts++;
+                if (decisionLevel() == 0) {
+                    mUnsatisfiable = true;
+                    return SatResult::UNSATISFIABLE;
+                }
+
+                backtrack(analyze(conflict));
+                learn();
+                mVariableIncrement /= kVariableDecay;
+                mClauseIncrement /= kClauseDecay;
+
+                /* Polling the cancel flag and the clock is cheap, but not free. */
+                if ((stats.conflicts & 255) == 0) {
+                    if (control.conflictCounter) *control.conflictCounter += 256;
+                    if (shouldStop(control)) {
+                        interrupted = true;
+                        return SatResult::UNKNOWN;
+                    }
+                }
+                continue;
+            }
+
+            if (conflicts >= conflictLimit) {
+                backtrack(0);
+                return SatResult::UNKNOWN;
+            }
+            if (mNumLearned - int(mTrail.size()) >= mMaxLearned) {
+                reduceLearned();
+                mMaxLearned *= 1.1;
+            }
+
+            int variable = -1;
+            while (variable == -1 && !mHeap.empty()) {
+                int next = heapPop();
+                if (mAssigns[next] == 0) variable = next;
+            }
+            if (variable == -1) return SatResult::SATISFIABLE;
+
+            stats.decisions++;
+            if ((stats.decisions & 1023) == 0 && shouldStop(control)) {
+                interrupted = true;
+                return SatResult::UNKNOWN;
+            }
+            mTrailLimits.push_back(int(mTrail.size()));
+            assign(mPolarity[variable]? positive(variable) : negative(variable), -1);
+        }
+    }
+
+    SatResult SatSolver::solve(const SatControl& control) {
+        stats.interrupted = false;
+        if (mUnsatisfiable) return SatResult::UNSATISFIABLE;
+        if (mMaxLearned == 0) mMaxLearned = max(2000.0, mClauses.size() / 3.0);
+
+        SatResult result = SatResult::UNKNOWN;
+        bool interrupted = false;
+        for (int restart = 0; result == SatResult::UNKNOWN && !interrupted; restart++) {
+            if (restart > 0) stats.restarts++;
+            result = search(luby(restart) * kRestartInterval, control, interrupted);
+        }
+        stats.interrupted = interrupted;
+
+        if (result == SatResult::SATISFIABLE) {
+            mModel.assign(numVariables(), false);
+            for (int variable = 0; variable < numVariables(); variable++) {
+                mModel[variable] = mAssigns[variable] > 0;
+            }
+        }
+        backtrack(0);
+        return result;
+    }
+
+    void SatSolver::bumpVariable(int variable) {
+        mActivity[variable] += mVariableIncrement;
+        if (mActivity[variable] > 1e100) {
+            for (double& activity: mActivity) activity *= 1e-100;
+            mVariableIncrement *= 1e-100;
+        }
+        if (mHeapIndex[variable] != -1) heapUp(mHeapIndex[variable]);
+    }
+
+    void SatSolver::bumpClause(Clause& clause) {
+        clause.activity += mClauseIncrement;
+        if (clause.activity > 1e20) {
+            for (Clause& other: mClauses) other.activity *= 1e-20;
+            mClauseIncrement *= 1e-20;
+        }
+    }
+
+    /* The heap is a binary max-heap on activity. */
+    void SatSolver::heapInsert(int variable) {
+        if (mHeapIndex[variable] != -1) return;
+        mHeapIndex[variable] = int(mHeap.size());
+        mHeap.push_back(variable);
+        heapUp(int(mHeap.size()) - 1);
+    }
+
+    void SatSolver::heapUp(int position) {
+        int variable = mHeap[position];
+        while (position > 0) {
+            int parent = (position - 1) / 2;
+            if (mActivity[mHeap[parent]] >= mActivity[variable]) break;
+            mHeap[position] = mHeap[parent];
+            mHeapIndex[mHeap[position]] = position;
+            position = parent;
+        }
+        mHeap[position] = variable;
+        mHeapIndex[variable] = position;
+    }
+
+    void SatSolver::heapDown(int position) {
+        int variable = mHeap[position];
+        int size = int(mHeap.size());
+        while (2 * position + 1 < size) {
+            int child = 2 * position + 1;
+            if (child + 1 < size && mActivity[mHeap[child + 1]] > mActivity[mHeap[child]]) child++;
+            if (mActivity[mHeap[child]] <= mActivity[variable]) break;
+            mHeap[position] = mHeap[child];
+            mHeapIndex[mHeap[position]] = position;
+            position = child;
+        }
+        mHeap[position] = variable;
+        mHeapIndex[variable] = position;
+    }
+
+    int SatSolver::heapPop() {
+        int top = mHeap[0];
+        mHeapIndex[top] = -1;
+        int last = mHeap.back();
+        mHeap.pop_back();
+        if (!mHeap.empty()) {
+            mHeap[0] = last;
+            mHeapIndex[last] = 0;
+            heapDown(0);
+        }
+        return top;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include <random>
+
+STUDENT_TEST("The SAT solver settles pigeonhole and random 3-SAT formulas correctly.") {
+    using namespace Disaster;
+
+    /* Five pigeons don't fit in four holes, but four do. */
+    for (int pigeons: { 4, 5 }) {
+        SatSolver solver;
+        auto in = [&](int pigeon, int hole) { return pigeon * 4 + hole; };
+        for (int i = 0; i < pigeons * 4; i++) solver.newVariable();
+
+        for (int pigeon = 0; pigeon < pigeons; pigeon++) {
+            std::vector<Literal> somewhere;
+            for (int hole = 0; hole < 4; hole++) somewhere.push_back(positive(in(pigeon, hole)));
+            solver.addClause(somewhere);
+        }
+        for (int hole = 0; hole < 4; hole++) {
+            for (int a = 0; a < pigeons; a++) {
+                for (int b = a + 1; b < pigeons; b++) {
+                    solver.addClause({ negative(in(a, hole)), negative(in(b, hole)) });
+                }
+            }
+        }
+        EXPECT(solver.solve() == (pigeons == 4? SatResult::SATISFIABLE : SatResult::UNSATISFIABLE));
+    }
+
+    /* Random 3-SAT near the threshold, checked against every assignment. */
+    std::mt19937 generator(106);
+    for (int round = 0; round < 100; round++) {
+        const int numVariables = 12;
+        std::vector<std::vector<Literal>> clauses(51);
+        for (auto& clause: clauses) {
+            for (int i = 0; i < 3; i++) {
+                int variable = int(generator() % numVariables);
+                clause.push_back(generator() % 2? positive(variable) : negative(variable));
+            }
+        }
+
+        auto satisfies = [&](auto isTrue) {
+            for (const auto& clause: clauses) {
+                bool any = false;
+                for (Literal literal: clause) {
+                    any = any || isTrue(variableOf(literal)) == (literal == positive(variableOf(literal)));
+                }
+                if (!any) return false;
+            }
+            return true;
+        };
+
+        bool expected = false;
+        for (int mask = 0; mask < (1 << numVariables) && !expected; mask++) {
+            expected = satisfies([&](int variable) { return bool(mask & (1 << variable)); });
+        }
+
+        SatSolver solver;
+        for (int i = 0; i < numVariables; i++) solver.newVariable();
+        for (const auto& clause: clauses) solver.addClause(clause);
+        SatResult result = solver.solve();
+
+        EXPECT(result == (expected? SatResult::SATISFIABLE : SatResult::UNSATISFIABLE));
+        if (result == SatResult::SATISFIABLE) {
+            EXPECT(satisfies([&](int variable) { return solver.value(variable); }));
+        }
+    }
+}
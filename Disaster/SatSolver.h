@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace Disaster {
+    /* A literal: variable v appears as 2v when positive and as 2v + 1 when negated. */
+    using Literal = int;
+
+    inline Literal positive(int variable) { return 2 * variable; }
+    inline Literal negative(int variable) { return 2 * variable + 1; }
+    inline Literal negation(Literal literal) { return literal ^ 1; }
+    inline int variableOf(Literal literal) { return literal >> 1; }
+
+    /* What a call to SatSolver::solve established. */
+    enum class SatResult {
+        SATISFIABLE,
+        UNSATISFIABLE,
+        UNKNOWN         // Cancelled, or out of time
+    };
+
+    /* Counters describing what the SAT solver did. */
+    struct SatStats {
+        long long decisions    = 0;  // Branching assignments
+        long long propagations = 0;  // Literals whose watch lists were scanned
+        long long conflicts    = 0;  // Clauses falsified, each yielding a learned clause
+        long long restarts     = 0;  // Returns to decision level zero
+        long long deleted      = 0;  // Learned clauses thrown out to save memory
+        bool interrupted       = false;  // Stopped early by cancellation or the deadline
+
+        SatStats& operator+= (const SatStats& rhs);
+    };
+
+    /* Knobs for limiting a SAT solve from the outside. */
+    struct SatControl {
+        /* If non-null, the solver gives up soon after this becomes true. */
+        const std::atomic<bool>* cancel = nullptr;
+
+        /* The solver also gives up soon after this time. */
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+        /* If non-null, the solver adds its conflicts to this as it goes, in batches. */
+        std::atomic<long long>* conflictCounter = nullptr;
+    };
+
+    /**
+     * A small conflict-driven clause-learning SAT solver.
+     * <p>
+     * Unit propagation uses two watched literals per clause, so backtracking costs
+     * nothing beyond unwinding the trail. Each conflict is analyzed back to its first
+     * unique implication point, and the learned clause is shortened by dropping
+     * literals implied by the rest. Branching follows VSIDS: variables in recent
+     * conflicts get priority, and each takes the value it last had (phase saving).
+     * The search restarts on the Luby schedule, and the least active half of the
+     * learned clauses is thrown out whenever there are too many.
+     */
+    class SatSolver {
+    public:
+        /* Adds a fresh variable and returns its index. */
+        int newVariable();
+
+        int numVariables() const {
+            return int(mAssigns.size());
+        }
+
+        /* Adds a clause: at least one of the literals must be true. Clauses can only be
+         * added between calls to solve.
+         */
+        void addClause(std::vector<Literal> clause);
+
+        /* Looks for an assignment satisfying every clause added so far. */
+        SatResult solve(const SatControl& control = {});
+
+        /* The variable's value in the assignment found by the last successful solve. */
+        bool value(int variable) const {
+            return mModel[variable];
+        }
+
+        SatStats stats;
+
+    private:
+        struct Clause {
+            std::vector<Literal> literals;  // The first two are watched
+            bool learned = false;
+            double activity = 0;
+        };
+
+        struct Watch {
+            int clause;
+            Literal blocker;  // Some other literal of the clause; if true, skip the clause
+        };
+
+        std::vector<Clause> mClauses;
+        std::vector<int> mFreeClauses;              // Slots of deleted learned clauses
+        std::vector<std::vector<Watch>> mWatches;   // Per literal: clauses watching it
+
+        std::vector<signed char> mAssigns;          // Per variable: 1 true, -1 false, 0 unset
+        std::vector<int> mLevels;                   // Decision level of each assignment
+        std::vector<int> mReasons;                  // Clause that implied it, or -1
+        std::vector<char> mPolarity;                // Last value held (phase saving)
+        std::vector<char> mSeen;                    // Scratch space for conflict analysis
+        std::vector<Literal> mLearned;              // Scratch space for conflict analysis
+        std::vector<Literal> mCollected;            // Scratch space for conflict analysis
+        std::vector<bool> mModel;
+
+        std::vector<Literal> mTrail;                // Assignments in order
+        std::vector<int> mTrailLimits;              // Where each decision level starts
+        std::size_t mHead = 0;                      // Next trail entry to propagate
+
+        std::vector<double> mActivity;              // VSIDS scores
+        double mVariableIncrement = 1;
+        double mClauseIncrement = 1;
+        std::vector<int> mHeap;                     // Unassigned variables by activity
+        std::vector<int> mHeapIndex;                // Position in mHeap, or -1
+
+        int mNumLearned = 0;
+        double mMaxLearned = 0;
+        bool mUnsatisfiable = false;                // Some clause can never be satisfied
+
+        int valueOf(Literal literal) const {
+            int value = mAssigns[variableOf(literal)];
+            return (literal & 1)? -value : value;
+        }
+        int decisionLevel() const {
+            return int(mTrailLimits.size());
+        }
+
+        int store(const std::vector<Literal>& literals, bool learned);
+        void assign(Literal literal, int reason);
+        int propagate();
+        int analyze(int conflict);
+        bool redundant(Literal literal) const;
+        void backtrack(int level);
+        void learn();
+        void reduceLearned();
+        SatResult search(long long conflictLimit, const SatControl& control, bool& interrupted);
+        bool shouldStop(const SatControl& control);
+
+        void bumpVariable(int variable);
+        void bumpClause(Clause& clause);
+        void heapInsert(int variable);
+        void heapUp(int position);
+        void heapDown(int position);
+        int heapPop();
+    };
+}
@@ -0,0 +1,954 @@
+#include "Solver.h"
+#include "Components.h"
+#include "ThreadPool.h"
+#include "error.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* Components smaller than this are solved faster than a thread can be started. */
+        const int kParallelComponentSize = 24;
+
+        /* How often threads racing on one problem check whether their caller gave up. */
+        const chrono::milliseconds kRacePoll(10);
+
+        /* How one component turned out. */
+        struct ComponentResult {
+            bool found = false;
+            vector<CityId> cover;  // In the component's own ids
+            SearchStats stats;
+            SatStats sat;
+            bool byTreeDP = false;
+            bool byBlocks = false;
+            map<string, int> portfolioWins;
+            int budgetProbes = 0;
+            int settledProbes = 0;
+        };
+
+        /* The lower bound a search on the problem should start from: the caller's, if
+         * it worked one out, and otherwise the stronger certificate.
+         */
+        int certifiedBound(const CoverProblem& problem, const SearchControl& control) {
+            if (control.knownLowerBound > 0) return control.knownLowerBound;
+            return max(lowerBoundOnCover(problem), strongestCertificate(problem).bound);
+        }
+
+        /* Runs one backend other than the portfolio, adding what it did to the stats. */
+        bool runBackend(SolverBackend backend, const CoverProblem& problem, vector<CityId>& cover,
+                        const SearchControl& control, SearchStats& stats, SatStats& sat) {
+            bool found;
+            if (backend == SolverBackend::SAT) {
+                SatStats one;
+                found = findMinimumSatCover(problem, cover, &one, control);
+                sat += one;
+            } else if (backend == SolverBackend::MEASURE_AND_CONQUER) {
+                SearchStats one;
+                found = measureAndConquerCover(problem, cover, &one, control);
+                stats += one;
+            } else if (backend == SolverBackend::BRANCH_AND_BOUND) {
+                SearchStats one;
+                found = findMinimumSupplyCover(problem, cover, &one, control);
+                stats += one;
+            } else {
+                error("A portfolio can only race backends that run a single search.");
+            }
+            return found;
+        }
+
+        /* Reports an error, on the caller's thread, if the options ask for a portfolio
+         * the solver can't race.
+         */
+        void checkOptions(const SolverOptions& options) {
+            if (options.backend != SolverBackend::PORTFOLIO) return;
+            if (options.portfolio.empty()) error("A portfolio needs at least one backend to race.");
+            for (SolverBackend member: options.portfolio) {
+                if (member == SolverBackend::PORTFOLIO || member == SolverBackend::BUDGET_PROBES) {
+                    error("A portfolio can only race backends that run a single search.");
+                }
+            }
+        }
+
+        /* Races the portfolio's backends and local search on one problem, each on a
+         * thread of pool. They share the smallest cover size found so far, and the
+         * certificate bound tells them when a cover can't be beaten. The first backend
+         * to finish has proven the smallest cover anyone found minimum, so it wins and
+         * the rest are stopped; local search wins if it reaches the bound first, and
+         * stops once every backend is done. The losers' stopping doesn't count as an
+         * interruption, but the caller's does.
+         */
+        bool racePortfolio(const CoverProblem& problem, vector<CityId>& cover, const SearchControl& control,
+                           const SolverOptions& options, ThreadPool& pool, ComponentResult& result) {
+            const auto& members = options.portfolio;
+            int lowerBound = certifiedBound(problem, control);
+
+            atomic<int> sharedBest(control.upperLimit == INT_MAX? INT_MAX : control.upperLimit + 1);
+            atomic<bool> stop(false), claimed(false);
+            atomic<size_t> done(0);
+            string winner;
+            auto claim = [&](const string& name) {
+                bool expected = false;
+                if (claimed.compare_exchange_strong(expected, true)) winner = name;
+                stop = true;
+            };
+            auto memberDone = [&] {
+                if (++done == members.size()) stop = true;
+            };
+
+            SearchControl shared = control;
+            shared.cancel = &stop;
+            shared.threads = 1;
+            shared.nodeCounter = options.nodeCounter;
+            shared.sharedBest = &sharedBest;
+            shared.knownLowerBound = lowerBound;
+
+            /* Local search runs until someone stops it; it only supplies covers. */
+            AnytimeOptions heuristic;
+            heuristic.cancel = &stop;
+            heuristic.seconds = control.deadline == chrono::steady_clock::time_point::max()
+                              ? 1e6 : max(0.0, chrono::duration<double>(control.deadline - chrono::steady_clock::now()).count());
+
+            struct Entry {
+                vector<CityId> cover;
+                bool found = false;
+                SearchStats stats;
+                SatStats sat;
+            };
+            vector<Entry> entries(members.size() + 1);
+
+            vector<future<void>> pending;
+            for (size_t i = 0; i < members.size(); i++) {
+                pending.push_back(pool.submit([&, i] {
+                    Entry& entry = entries[i];
+                    try {
+                        entry.found = runBackend(members[i], problem, entry.cover, shared, entry.stats, entry.sat);
+                    } catch (...) {
+                        memberDone();
+                        throw;
+                    }
+                    if (!entry.stats.interrupted && !entry.sat.interrupted) claim(backendName(members[i]));
+                    memberDone();
+                }));
+            }
+            pending.push_back(pool.submit([&] {
+                Entry& entry = entries.back();
+                entry.found = anytimeSupplyCover(problem, entry.cover, heuristic, [&](const vector<CityId>& improved) {
+                    if (int(improved.size()) <= lowerBound) claim("local search");
+                    publishCover(shared, improved);
+                });
+            }));
+
+            /* Pass the caller's cancellation on to the racers, then collect any errors. */
+            for (auto& task: pending) {
+                while (task.wait_for(kRacePoll) != future_status::ready) {
+                    if (control.cancel && control.cancel->load()) stop = true;
+                }
+            }
+            for (auto& task: pending) task.get();
+
+            bool found = false;
+            for (Entry& entry: entries) {
+                entry.stats.interrupted = entry.sat.interrupted = false;
+                result.stats += entry.stats;
+                result.sat += entry.sat;
+
+                if (entry.found && int(entry.cover.size()) <= control.upperLimit &&
+                    (!found || entry.cover.size() < cover.size())) {
+                    cover = entry.cover;
+                    found = true;
+                }
+            }
+
+            if (claimed) {
+                result.portfolioWins[winner]++;
+            } else {
+                result.stats.interrupted = true;
+            }
+            return found;
+        }
+
+        /* Finds a minimum cover by deciding several budgets at once, one decision search
+         * per thread, where a binary search would decide one at a time. The budgets are
+         * spread evenly over the range the minimum could still be in. Feasibility only
+         * grows with the budget, so each answer settles more than its own budget: a
+         * cover with c cities settles every budget from c up, and an infeasible budget
+         * settles every budget below it. Probes whose budgets get settled are cancelled
+         * instead of left to finish, and once all of a round's probes are in, the next
+         * round splits whatever range is left. At most threads probes run at once, on
+         * pool. That count comes from the caller rather than control, which is one for
+         * every small component and would leave a plain binary search.
+         */
+        bool probeBudgets(const CoverProblem& problem, vector<CityId>& cover, const SearchControl& control,
+                          int threads, ThreadPool& pool, ComponentResult& result) {
+            if (!greedySupplyCover(problem, cover)) return false;
+
+            /* The minimum is at least low. If found is set, cover is a cover with high
+             * cities; otherwise nothing within the limit has turned up yet.
+             */
+            bool found = int(cover.size()) <= control.upperLimit;
+            int low = certifiedBound(problem, control);
+            int high = found? int(cover.size()) : control.upperLimit + 1;
+            if (found) publishCover(control, cover);
+
+            struct Probe {
+                int budget = 0;
+                atomic<bool> cancel{false};
+                bool found = false;
+                vector<CityId> cover;
+                SearchStats stats;
+            };
+
+            bool interrupted = false;
+            while (low < high && !interrupted) {
+                vector<Probe> probes(min(threads, high - low));
+                for (size_t i = 0; i < probes.size(); i++) {
+                    probes[i].budget = low + int((i + 1) * (long long)(high - low) / (probes.size() + 1));
+                }
+
+                mutex lock;
+                condition_variable signal;
+                vector<size_t> finished;
+                vector<future<void>> pending;
+                for (size_t i = 0; i < probes.size(); i++) {
+                    pending.push_back(pool.submit([&, i] {
+                        Probe& probe = probes[i];
+                        SearchControl probeControl = control;
+                        probeControl.cancel = &probe.cancel;
+                        probeControl.threads = 1;
+                        probe.found = findSupplyCover(problem, probe.budget, probe.cover, &probe.stats, probeControl);
+
+                        lock_guard<mutex> guard(lock);
+                        finished.push_back(i);
+                        signal.notify_one();
+                    }));
+                }
+
+                for (size_t answered = 0; answered < probes.size(); ) {
+                    vector<size_t> ready;
+                    {
+                        unique_lock<mutex> guard(lock);
+                        signal.wait_for(guard, kRacePoll, [&] { return !finished.empty(); });
+                        ready.swap(finished);
+                    }
+                    if (control.cancel && control.cancel->load()) interrupted = true;
+
+                    for (size_t i: ready) {
+                        Probe& probe = probes[i];
+                        if (probe.found) {
+                            if (int(probe.cover.size()) < high) {
+                                high = int(probe.cover.size());
+                                cover = probe.cover;
+                                found = true;
+                                publishCover(control, cover);
+                            }
+                        } else if (!probe.stats.interrupted) {
+                            low = max(low, probe.budget + 1);
+                        } else if (!probe.cancel) {
+                            interrupted = true;  // Out of time
+                        } else {
+                            result.settledProbes++;
+                        }
+
+                        probe.stats.interrupted = false;
+                        result.stats += probe.stats;
+                        result.budgetProbes++;
+                        answered++;
+                    }
+
+                    for (Probe& probe: probes) {
+                        if (interrupted || probe.budget < low || probe.budget >= high) probe.cancel = true;
+                    }
+                }
+                for (auto& task: pending) task.get();
+            }
+
+            if (interrupted) result.stats.interrupted = true;
+            return found;
+        }
+
+        /* Called with a component's index and a better cover of it, in its own ids. */
+        using ComponentCallback = function<void(size_t, const vector<CityId>&)>;
+
+        /* Solves the minimization problem on every component, with per-component size
+         * limits. Several large components run side by side on a thread pool; a lone
+         * large component gets a parallel search instead. Searches stop early when
+         * base's cancel flag or deadline says so. A component with no cover within its
+         * limit sets failed, if given, and once it's set no new components start.
+         * Covers the searches improve to along the way go to onCover, if set, and so
+         * does each component's final cover. Lower bounds the caller already has for
+         * the components go in bounds, which may be empty.
+         */
+        vector<ComponentResult> solveComponents(const vector<Subproblem>& components,
+                                                const vector<int>& limits,
+                                                const vector<int>& bounds,
+                                                const SolverOptions& options,
+                                                const SearchControl& base,
+                                                atomic<bool>* failed,
+                                                const ComponentCallback& onCover = {}) {
+            vector<ComponentResult> results(components.size());
+
+            int large = 0;
+            for (const auto& component: components) {
+                if (component.problem.graph.numCities() >= kParallelComponentSize) large++;
+            }
+            int threads = options.threads > 0? options.threads : ThreadPool::defaultThreads();
+
+            /* With at most one large component, its search gets all the threads. */
+            int searchThreads = large >= 2? 1 : threads;
+            bool sideBySide = large >= 2 && threads > 1;
+            int concurrent = sideBySide? min(threads, large) : 1;
+
+            /* Every race in the solve shares one pool, with a thread for each racer of
+             * each component that can be racing at once, so no racer waits for a thread.
+             */
+            unique_ptr<ThreadPool> racePool;
+            if (options.backend == SolverBackend::PORTFOLIO) {
+                racePool = make_unique<ThreadPool>(int(options.portfolio.size() + 1) * concurrent);
+            }
+
+            /* Budget probes split the threads among the components running at once. */
+            int probeThreads = max(1, threads / concurrent);
+            unique_ptr<ThreadPool> probePool;
+            if (options.backend == SolverBackend::BUDGET_PROBES) {
+                probePool = make_unique<ThreadPool>(probeThreads * concurrent);
+            }
+
+            auto solveOne = [&](size_t index) {
+                const CoverProblem& problem = components[index].problem;
+                ComponentResult& result = results[index];
+
+                /* Narrow components don't need a search at all. */
+                if (options.maxTreewidth >= 0) {
+                    TreeDecomposition decomposition = treeDecomposition(problem.graph, options.maxTreewidth);
+                    if (decomposition.numNodes() == problem.graph.numCities()) {
+                        result.byTreeDP = true;
+                        bool solved = treeDPSupplyCover(problem, decomposition, result.cover, &result.stats, base);
+
+                        /* Out of time: settle for a greedy cover, which the stats mark as unproven. */
+                        if (result.stats.interrupted) solved = greedySupplyCover(problem, result.cover);
+                        result.found = solved && int(result.cover.size()) <= limits[index];
+                        if (!result.found && failed) *failed = true;
+                        if (result.found && onCover) onCover(index, result.cover);
+                        return;
+                    }
+                }
+
+                SearchControl control = base;
+                control.upperLimit = limits[index];
+                control.threads = problem.graph.numCities() >= kParallelComponentSize? searchThreads : 1;
+                control.taskGranularity = options.taskGranularity;
+                control.nodeCounter = options.nodeCounter;
+                if (!bounds.empty()) control.knownLowerBound = bounds[index];
+                if (onCover) {
+                    control.onImprovement = [&, index](const vector<CityId>& cover) {
+                        onCover(index, cover);
+                    };
+                }
+
+                /* Searches one subproblem, adding what it did to the component's stats. */
+                auto search = [&](const CoverProblem& subproblem, vector<CityId>& cover, const SearchControl& control) {
+                    if (options.backend == SolverBackend::PORTFOLIO) {
+                        return racePortfolio(subproblem, cover, control, options, *racePool, result);
+                    }
+                    if (options.backend == SolverBackend::BUDGET_PROBES) {
+                        return probeBudgets(subproblem, cover, control, probeThreads, *probePool, result);
+                    }
+                    return runBackend(options.backend, subproblem, cover, control, result.stats, result.sat);
+                };
+
+                /* Cut cities split the search into one small search per block and case.
+                 * The blocks' covers say nothing about the component's limit, so only
+                 * the assembled cover is checked against it.
+                 */
+                BlockCutTree tree = blockCutTree(problem.graph);
+                if (tree.numBlocks() > 1) {
+                    SearchControl blockControl = control;
+                    blockControl.upperLimit = INT_MAX;
+                    blockControl.onImprovement = nullptr;  // A block's cover isn't the component's
+                    blockControl.knownLowerBound = 0;      // Nor is its bound
+
+                    bool interrupted = false;
+                    result.byBlocks = true;
+                    result.found = blockCutSupplyCover(problem, tree, result.cover,
+                                                       [&](const CoverProblem& block, vector<CityId>& cover) {
+                        if (options.maxTreewidth >= 0) {
+                            TreeDecomposition decomposition = treeDecomposition(block.graph, options.maxTreewidth);
+                            if (decomposition.numNodes() == block.graph.numCities()) {
+                                SearchStats dp;
+                                bool found = treeDPSupplyCover(block, decomposition, cover, &dp, blockControl);
+                                interrupted = interrupted || dp.interrupted;
+                                return found && !interrupted;
+                            }
+                        }
+
+                        bool found = search(block, cover, blockControl);
+                        interrupted = interrupted || result.stats.interrupted || result.sat.interrupted;
+                        return found && !interrupted;
+                    });
+
+                    /* Out of time: settle for a greedy cover, which the stats mark as unproven. */
+                    if (interrupted) {
+                        result.found = greedySupplyCover(problem, result.cover);
+                        result.stats.interrupted = true;
+                    }
+                    result.found = result.found && int(result.cover.size()) <= limits[index];
+                } else {
+                    result.found = search(problem, result.cover, control);
+                }
+
+                /* One component over its limit sinks the whole budget. */
+                if (!result.found && failed) *failed = true;
+                if (result.found && onCover) onCover(index, result.cover);
+            };
+
+            if (!sideBySide) {
+                for (size_t i = 0; i < components.size() && !(failed && *failed); i++) {
+                    solveOne(i);
+                }
+            } else {
+                ThreadPool pool(concurrent);
+                vector<future<void>> pending;
+                for (size_t i = 0; i < components.size(); i++) {
+                    pending.push_back(pool.submit([&, i] {
+                        solveOne(i);
+                    }));
+                }
+                for (auto& task: pending) task.get();
+            }
+            return results;
+        }
+
+        /* Keeps the best cover found so far of each component, and reports their union,
+         * lifted to the original network, whenever one of them shrinks. Components start
+         * out with greedy covers, so there's always a whole cover to report.
+         */
+        class IncumbentTracker {
+        public:
+            IncumbentTracker(const Kernel& kernel, const vector<Subproblem>& components,
+                             const CoverCallback& onImprovement)
+                : mKernel(kernel), mComponents(components), mOnImprovement(onImprovement),
+                  mCovers(components.size()) {
+                for (size_t i = 0; i < components.size(); i++) {
+                    if (!greedySupplyCover(components[i].problem, mCovers[i])) {
+                        error("Internal error: every road network has a cover.");
+                    }
+                }
+                report();
+            }
+
+            /* Takes a new cover of one component, in the component's own ids. */
+            void update(size_t index, const vector<CityId>& cover) {
+                lock_guard<mutex> guard(mLock);
+                if (cover.size() >= mCovers[index].size()) return;
+
+                mCovers[index] = cover;
+                report();
+            }
+
+        private:
+            const Kernel& mKernel;
+            const vector<Subproblem>& mComponents;
+            CoverCallback mOnImprovement;
+            mutex mLock;                    // Guards mCovers
+            vector<vector<CityId>> mCovers;
+
+            void report() {
+                vector<CityId> kernelCover;
+                for (size_t i = 0; i < mComponents.size(); i++) {
+                    for (CityId city: mCovers[i]) {
+                        kernelCover.push_back(mComponents[i].original[city]);
+                    }
+                }
+                mOnImprovement(mKernel.lift(kernelCover));
+            }
+        };
+
+        /* Kernelizes and splits the network. Returns false if the kernel is infeasible. */
+        bool prepare(const RoadGraph& graph, Kernel& kernel, vector<Subproblem>& components,
+                     SolverStats& stats) {
+            kernel = kernelize(CoverProblem(graph));
+            stats.kernel = kernel.stats;
+            if (kernel.infeasible) return false;
+
+            components = connectedComponents(kernel.problem);
+            stats.components = int(components.size());
+            return true;
+        }
+
+        /* Adds what the components' solves did to the stats. */
+        void addStats(const vector<ComponentResult>& results, SolverStats& stats) {
+            for (size_t i = 0; i < results.size(); i++) {
+                stats.search += results[i].stats;
+                stats.sat += results[i].sat;
+                if (results[i].byTreeDP) stats.treeDPComponents++;
+                if (results[i].byBlocks) stats.blockCutComponents++;
+                stats.budgetProbes += results[i].budgetProbes;
+                stats.settledProbes += results[i].settledProbes;
+                for (const auto& win: results[i].portfolioWins) {
+                    stats.portfolioWins[win.first] += win.second;
+                }
+            }
+        }
+
+        /* Lifts per-component covers back to the original network. */
+        vector<CityId> assemble(const Kernel& kernel, const vector<Subproblem>& components,
+                                const vector<ComponentResult>& results, SolverStats& stats) {
+            vector<CityId> kernelCover;
+            for (size_t i = 0; i < components.size(); i++) {
+                for (CityId city: results[i].cover) {
+                    kernelCover.push_back(components[i].original[city]);
+                }
+            }
+            addStats(results, stats);
+            return kernel.lift(kernelCover);
+        }
+    }
+
+    string backendName(SolverBackend backend) {
+        switch (backend) {
+            case SolverBackend::BRANCH_AND_BOUND:    return "branch and bound";
+            case SolverBackend::SAT:                 return "SAT";
+            case SolverBackend::MEASURE_AND_CONQUER: return "measure and conquer";
+            case SolverBackend::PORTFOLIO:           return "portfolio";
+            case SolverBackend::BUDGET_PROBES:       return "budget probes";
+        }
+        error("Unknown solver backend.");
+    }
+
+    bool findCoverWithin(const RoadGraph& graph, int budget, vector<CityId>& cover,
+                         const SolverOptions& options, SolverStats* stats) {
+        checkOptions(options);
+        SolverStats local;
+        if (!stats) stats = &local;
+        *stats = SolverStats();
+
+        Kernel kernel;
+        vector<Subproblem> components;
+        if (!prepare(graph, kernel, components, *stats)) return false;
+
+        /* Forced picks come out of the budget first. */
+        int remaining = budget - int(kernel.forced.size());
+        if (remaining < 0) return false;
+
+        /* Any cover within the budget answers the question, not just a minimum one. The
+         * tracker starts from the components' greedy covers, which settle most generous
+         * budgets without searching, and after that it stops the searches as soon as
+         * their best covers add up to few enough cities.
+         */
+        atomic<bool> stop(false);
+        bool fits = false;
+        IncumbentTracker tracker(kernel, components, [&](const vector<CityId>& whole) {
+            if (!fits && int(whole.size()) <= budget) {
+                cover = whole;
+                fits = true;
+                stop = true;
+            }
+        });
+        if (fits) return true;
+
+        /* Each component's cost is a step function starting at its minimum, so splitting
+         * the budget is a knapsack whose answer is "sum of minima <= budget". We don't
+         * know the minima up front, but lower bounds on the others cap how much budget
+         * any one component can use, so components that can't fit fail fast. The
+         * certificates are cheap next to a search and usually within a city or two of
+         * the minimum, so budgets that are too small rarely need searching at all.
+         */
+        vector<int> bounds, limits;
+        int boundTotal = 0;
+        for (const auto& component: components) {
+            bounds.push_back(max(lowerBoundOnCover(component.problem),
+                                 strongestCertificate(component.problem).bound));
+            boundTotal += bounds.back();
+        }
+        if (boundTotal > remaining) return false;
+
+        for (int bound: bounds) {
+            limits.push_back(remaining - (boundTotal - bound));
+        }
+
+        /* A component over its limit stops the others too. If every search runs to the
+         * end, the tracker ends up holding each component's minimum, so it has seen a
+         * cover within the budget exactly when one exists.
+         */
+        SearchControl base;
+        base.cancel = &stop;
+        auto results = solveComponents(components, limits, bounds, options, base, &stop,
+                                       [&](size_t index, const vector<CityId>& componentCover) {
+            tracker.update(index, componentCover);
+        });
+        addStats(results, *stats);
+
+        /* Searches stopped because the answer was in aren't unfinished business. */
+        if (fits) stats->search.interrupted = stats->sat.interrupted = false;
+        return fits;
+    }
+
+    vector<CityId> findMinimumCover(const RoadGraph& graph, const SolverOptions& options,
+                                    SolverStats* stats) {
+        checkOptions(options);
+        SolverStats local;
+        if (!stats) stats = &local;
+        *stats = SolverStats();
+
+        Kernel kernel;
+        vector<Subproblem> components;
+        if (!prepare(graph, kernel, components, *stats)) {
+            error("Internal error: every road network has a cover.");
+        }
+
+        unique_ptr<IncumbentTracker> tracker;
+        ComponentCallback onCover;
+        if (options.onImprovement) {
+            tracker = make_unique<IncumbentTracker>(kernel, components, options.onImprovement);
+            onCover = [&](size_t index, const vector<CityId>& cover) {
+                tracker->update(index, cover);
+            };
+        }
+
+        auto results = solveComponents(components, vector<int>(components.size(), INT_MAX), {},
+                                       options, SearchControl(), nullptr, onCover);
+        for (const auto& result: results) {
+            if (!result.found) error("Internal error: every road network has a cover.");
+        }
+        return assemble(kernel, components, results, *stats);
+    }
+
+    SolveResult findMinimumCoverBy(const RoadGraph& graph, chrono::steady_clock::time_point deadline,
+                                   const atomic<bool>* cancel, const SolverOptions& options,
+                                   SolverStats* stats) {
+        checkOptions(options);
+        SolverStats local;
+        if (!stats) stats = &local;
+        *stats = SolverStats();
+
+        SolveResult result;
+        if (chrono::steady_clock::now() >= deadline || (cancel && *cancel)) return result;
+
+        Kernel kernel;
+        vector<Subproblem> components;
+        if (!prepare(graph, kernel, components, *stats)) {
+            error("Internal error: every road network has a cover.");
+        }
+
+        /* Every search starts from a greedy cover, so even an interrupted one has
+         * something to report.
+         */
+        SearchControl base;
+        base.cancel = cancel;
+        base.deadline = deadline;
+        unique_ptr<IncumbentTracker> tracker;
+        ComponentCallback onCover;
+        if (options.onImprovement) {
+            tracker = make_unique<IncumbentTracker>(kernel, components, options.onImprovement);
+            onCover = [&](size_t index, const vector<CityId>& cover) {
+                tracker->update(index, cover);
+            };
+        }
+
+        auto results = solveComponents(components, vector<int>(components.size(), INT_MAX), {},
+                                       options, base, nullptr, onCover);
+
+        /* Components that finished contribute their exact minimum to the bound; the
+         * rest contribute what the bound gives without searching. Time is already up
+         * for those, so they skip the fractional certificate, which takes quadratic time.
+         */
+        result.lowerBound = int(kernel.forced.size());
+        for (size_t i = 0; i < components.size(); i++) {
+            if (!results[i].found) error("Internal error: every road network has a cover.");
+
+            bool finished = !results[i].stats.interrupted && !results[i].sat.interrupted;
+            result.lowerBound += finished? int(results[i].cover.size())
+                                         : max(lowerBoundOnCover(components[i].problem),
+                                               packingCertificate(components[i].problem).bound);
+        }
+
+        result.cover = assemble(kernel, components, results, *stats);
+        result.status = int(result.cover.size()) == result.lowerBound? SolveStatus::OPTIMAL
+                                                                     : SolveStatus::FEASIBLE;
+        return result;
+    }
+
+    vector<CityId> findGoodCover(const RoadGraph& graph, const AnytimeOptions& options,
+                                 const CoverCallback& onImprovement) {
+        Kernel kernel = kernelize(CoverProblem(graph));
+        if (kernel.infeasible) error("Internal error: every road network has a cover.");
+
+        vector<CityId> kernelCover;
+        bool found = anytimeSupplyCover(kernel.problem, kernelCover, options, [&](const vector<CityId>& improved) {
+            if (onImprovement) onImprovement(kernel.lift(improved));
+        });
+        if (!found) error("Internal error: every road network has a cover.");
+
+        return kernel.lift(kernelCover);
+    }
+}
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+namespace {
+    /* Several disjoint copies of a rows x cols grid. */
+    Disaster::RoadGraph gridIslands(int copies, int rows, int cols) {
+        std::vector<std::string> names;
+        std::vector<std::pair<Disaster::CityId, Disaster::CityId>> roads;
+        for (int copy = 0; copy < copies; copy++) {
+            for (int row = 0; row < rows; row++) {
+                for (int col = 0; col < cols; col++) {
+                    Disaster::CityId id = Disaster::CityId(names.size());
+                    names.push_back(std::to_string(copy) + ":" + std::to_string(row) + "," + std::to_string(col));
+                    if (row > 0) roads.emplace_back(id, id - cols);
+                    if (col > 0) roads.emplace_back(id, id - 1);
+                }
+            }
+        }
+        return Disaster::RoadGraph(names, roads);
+    }
+}
+
+STUDENT_TEST("Islands are solved independently, with any number of threads.") {
+    using namespace Disaster;
+
+    /* Each 6 x 6 grid needs 10 cities. */
+    RoadGraph islands = gridIslands(4, 6, 6);
+
+    for (int threads: { 1, 4 }) {
+        SolverOptions options;
+        options.threads = threads;
+        options.maxTreewidth = -1;
+
+        SolverStats stats;
+        EXPECT_EQUAL(findMinimumCover(islands, options, &stats).size(), 40);
+        EXPECT_EQUAL(stats.components, 4);
+
+        std::vector<CityId> cover;
+        EXPECT(findCoverWithin(islands, 40, cover, options));
+        EXPECT_EQUAL(cover.size(), 40);
+        EXPECT(!findCoverWithin(islands, 39, cover, options));
+    }
+}
+
+STUDENT_TEST("A generous budget is settled without a long search.") {
+    using namespace Disaster;
+
+    /* 120 cities with about six roads each. Greedy needs a few dozen of them. */
+    std::mt19937 generator(120);
+    RoadGraph graph = randomNetwork(generator, 120, 5);
+
+    SolverStats stats;
+    std::vector<CityId> cover;
+    EXPECT(findCoverWithin(graph, 80, cover, {}, &stats));
+    EXPECT_LESS_THAN_OR_EQUAL_TO(cover.size(), 80);
+    EXPECT_LESS_THAN(stats.search.nodes, 1000);
+    EXPECT(isValidCover(CoverProblem(graph), cover));
+}
+
+STUDENT_TEST("Narrow components are solved by tree-decomposition DP.") {
+    using namespace Disaster;
+
+    /* 3 x 12 grids have treewidth 3 and need 10 cities each. */
+    RoadGraph islands = gridIslands(3, 3, 12);
+
+    SolverStats stats;
+    EXPECT_EQUAL(findMinimumCover(islands, {}, &stats).size(), 30);
+    EXPECT_EQUAL(stats.treeDPComponents, stats.components);
+    EXPECT_EQUAL(stats.search.nodes, 0);
+
+    SolverOptions branching;
+    branching.maxTreewidth = -1;
+    EXPECT_EQUAL(findMinimumCover(islands, branching, &stats).size(), 30);
+    EXPECT_EQUAL(stats.treeDPComponents, 0);
+
+    std::vector<CityId> cover;
+    EXPECT(findCoverWithin(islands, 30, cover));
+    EXPECT(!findCoverWithin(islands, 29, cover));
+}
+
+STUDENT_TEST("The SAT backend gives the same answers as branch and bound.") {
+    using namespace Disaster;
+
+    /* Each 5 x 5 grid needs 7 cities. */
+    RoadGraph islands = gridIslands(3, 5, 5);
+    SolverOptions options;
+    options.maxTreewidth = -1;
+    options.backend = SolverBackend::SAT;
+
+    SolverStats stats;
+    EXPECT_EQUAL(findMinimumCover(islands, options, &stats).size(), 21);
+    EXPECT_GREATER_THAN(stats.sat.conflicts, 0);
+    EXPECT_EQUAL(stats.search.nodes, 0);
+
+    std::vector<CityId> cover;
+    EXPECT(findCoverWithin(islands, 21, cover, options));
+    EXPECT_EQUAL(cover.size(), 21);
+    EXPECT(!findCoverWithin(islands, 20, cover, options));
+}
+
+STUDENT_TEST("The measure-and-conquer backend gives the same answers as branch and bound.") {
+    using namespace Disaster;
+
+    RoadGraph islands = gridIslands(3, 5, 5);
+    SolverOptions options;
+    options.maxTreewidth = -1;
+    options.backend = SolverBackend::MEASURE_AND_CONQUER;
+
+    SolverStats stats;
+    EXPECT_EQUAL(findMinimumCover(islands, options, &stats).size(), 21);
+    EXPECT_GREATER_THAN(stats.search.nodes, 0);
+
+    std::vector<CityId> cover;
+    EXPECT(findCoverWithin(islands, 21, cover, options));
+    EXPECT_EQUAL(cover.size(), 21);
+    EXPECT(!findCoverWithin(islands, 20, cover, options));
+}
+
+STUDENT_TEST("A portfolio race gives the same answers and records who won.") {
+    using namespace Disaster;
+
+    RoadGraph islands = gridIslands(3, 5, 5);
+    SolverOptions options;
+    options.maxTreewidth = -1;
+    options.backend = SolverBackend::PORTFOLIO;
+
+    SolverStats stats;
+    EXPECT_EQUAL(findMinimumCover(islands, options, &stats).size(), 21);
+    EXPECT(!stats.search.interrupted);
+
+    /* One race per grid, each won by someone. */
+    int races = 0;
+    for (const auto& win: stats.portfolioWins) races += win.second;
+    EXPECT_EQUAL(races, 3);
+
+    std::vector<CityId> cover;
+    EXPECT(findCoverWithin(islands, 21, cover, options));
+    EXPECT_EQUAL(cover.size(), 21);
+    EXPECT(!findCoverWithin(islands, 20, cover, options));
+
+    /* A lone member races only local search. */
+    options.portfolio = { SolverBackend::SAT };
+    EXPECT_EQUAL(findMinimumCover(gridIslands(1, 6, 6), options, &stats).size(), 10);
+    EXPECT_EQUAL(stats.portfolioWins.size(), 1);
+    EXPECT_EQUAL(stats.portfolioWins.count("branch and bound") + stats.portfolioWins.count("measure and conquer"), 0);
+
+    /* Portfolios that can't be raced are caught before anything starts. */
+    std::vector<CityId> unused;
+    options.portfolio = {};
+    EXPECT_ERROR(findMinimumCover(islands, options));
+    options.portfolio = { SolverBackend::SAT, SolverBackend::PORTFOLIO };
+    EXPECT_ERROR(findCoverWithin(islands, 21, unused, options));
+    options.portfolio = { SolverBackend::BUDGET_PROBES };
+    EXPECT_ERROR(findMinimumCoverBy(islands, std::chrono::steady_clock::now() + std::chrono::seconds(60),
+                                    nullptr, options));
+}
+
+STUDENT_TEST("Probing several budgets at once finds the same minimum.") {
+    using namespace Disaster;
+
+    /* Each 6 x 6 grid needs 10 cities. */
+    RoadGraph islands = gridIslands(2, 6, 6);
+    for (int threads: { 1, 4 }) {
+        SolverOptions options;
+        options.threads = threads;
+        options.maxTreewidth = -1;
+        options.backend = SolverBackend::BUDGET_PROBES;
+
+        SolverStats stats;
+        EXPECT_EQUAL(findMinimumCover(islands, options, &stats).size(), 20);
+        EXPECT(!stats.search.interrupted);
+        EXPECT_GREATER_THAN(stats.budgetProbes, 0);
+        EXPECT_LESS_THAN_OR_EQUAL_TO(stats.settledProbes, stats.budgetProbes);
+
+        std::vector<CityId> cover;
+        EXPECT(findCoverWithin(islands, 20, cover, options));
+        EXPECT_EQUAL(cover.size(), 20);
+        EXPECT(!findCoverWithin(islands, 19, cover, options));
+    }
+}
+
+STUDENT_TEST("The exact solvers report each smaller cover of the whole network.") {
+    using namespace Disaster;
+
+    /* Each 6 x 6 grid needs 10 cities. */
+    RoadGraph islands = gridIslands(2, 6, 6);
+
+    for (SolverBackend backend: { SolverBackend::BRANCH_AND_BOUND, SolverBackend::PORTFOLIO,
+                                  SolverBackend::BUDGET_PROBES }) {
+        std::vector<size_t> sizes;
+        SolverOptions options;
+        options.maxTreewidth = -1;
+        options.backend = backend;
+        options.onImprovement = [&](const std::vector<CityId>& cover) {
+            EXPECT(isValidCover(CoverProblem(islands), cover));
+            EXPECT(sizes.empty() || cover.size() < sizes.back());
+            sizes.push_back(cover.size());
+        };
+
+        EXPECT_EQUAL(findMinimumCover(islands, options).size(), 20);
+        EXPECT_EQUAL(sizes.back(), 20);
+
+        sizes.clear();
+        SolveResult result = findMinimumCoverBy(islands, std::chrono::steady_clock::now() + std::chrono::seconds(60),
+                                                nullptr, options);
+        EXPECT_EQUAL(result.cover.size(), 20);
+        EXPECT_EQUAL(sizes.back(), 20);
+    }
+}
+
+STUDENT_TEST("findGoodCover reports covers of the original network.") {
+    using namespace Disaster;
+
+    RoadGraph islands = gridIslands(2, 5, 5);
+    AnytimeOptions options;
+    options.seconds = 0.2;
+
+    int reports = 0;
+    std::vector<CityId> cover = findGoodCover(islands, options, [&](const std::vector<CityId>& improved) {
+        reports++;
+        EXPECT_GREATER_THAN_OR_EQUAL_TO(improved.size(), 14);
+    });
+    EXPECT_GREATER_THAN(reports, 0);
+
+    /* Each 5 x 5 grid needs 7. */
+    EXPECT_GREATER_THAN_OR_EQUAL_TO(cover.size(), 14);
+    EXPECT(isValidCover(CoverProblem(islands), cover));
+}
+
+STUDENT_TEST("findMinimumCoverBy stops at the deadline with a cover and a lower bound.") {
+    using namespace Disaster;
+    using namespace std::chrono;
+
+    /* A 12 x 12 grid is far too wide for the DP and slow to solve by branching. */
+    RoadGraph grid = gridIslands(1, 12, 12);
+    std::atomic<long long> nodes(0);
+    SolverOptions options;
+    options.threads = 1;
+    options.maxTreewidth = -1;
+    options.nodeCounter = &nodes;
+
+    auto start = steady_clock::now();
+    SolveResult result = findMinimumCoverBy(grid, start + milliseconds(50), nullptr, options);
+    EXPECT_LESS_THAN(duration<double>(steady_clock::now() - start).count(), 2.0);
+    EXPECT_GREATER_THAN(nodes.load(), 0);
+
+    EXPECT(result.status != SolveStatus::TIMED_OUT);
+    EXPECT_LESS_THAN_OR_EQUAL_TO(result.lowerBound, int(result.cover.size()));
+    EXPECT(isValidCover(CoverProblem(grid), result.cover));
+
+    /* Small problems finish and are proven optimal. */
+    result = findMinimumCoverBy(gridIslands(2, 4, 4), start + seconds(60));
+    EXPECT(result.status == SolveStatus::OPTIMAL);
+    EXPECT_EQUAL(result.lowerBound, 8);
+    EXPECT_EQUAL(result.cover.size(), 8);
+
+    /* Cancelled before starting: nothing to report. */
+    std::atomic<bool> cancel(true);
+    result = findMinimumCoverBy(grid, start + seconds(60), &cancel);
+    EXPECT(result.status == SolveStatus::TIMED_OUT);
+    EXPECT(result.cover.empty());
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "RoadGraph.h"
+#include "Anytime.h"
+#include "BlockCutTree.h"
+#include "Certificate.h"
+#include "Kernel.h"
+#include "MeasureConquer.h"
+#include "SatCover.h"
+#include "SupplySearch.h"
+#include "TreeDP.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Disaster {
+    /* How components too wide for the DP get solved. */
+    enum class SolverBackend {
+        BRANCH_AND_BOUND,     // The branch-and-bound search in SupplySearch
+        SAT,                  // A CNF encoding handed to the built-in SAT solver
+        MEASURE_AND_CONQUER,  // Set-cover branching with matching, in MeasureConquer
+        PORTFOLIO,            // The portfolio's backends racing each other on separate threads
+        BUDGET_PROBES         // Decision searches at several budgets at once, narrowing like a binary search
+    };
+
+    /* A short name for the backend, as used in SolverStats::portfolioWins. */
+    std::string backendName(SolverBackend backend);
+
+    /* Settings for the solver pipeline. */
+    struct SolverOptions {
+        /* Worker threads; 0 means one per core. Several large components are solved
+         * side by side; otherwise the threads share each component's search. Budget
+         * probes split the threads evenly among the components running at once, so a
+         * component solved alone gets them all, even when it's small.
+         */
+        int threads = 0;
+
+        /* Smallest subtree (in uncovered cities) worth handing to another thread. */
+        int taskGranularity = 24;
+
+        /* Components with a tree decomposition at most this wide are solved by dynamic
+         * programming instead of branching; -1 turns that off.
+         */
+        int maxTreewidth = kDefaultTreeDPWidth;
+
+        /* What solves the components the DP doesn't. */
+        SolverBackend backend = SolverBackend::BRANCH_AND_BOUND;
+
+        /* The backends a PORTFOLIO races, each on a thread of its own. Local search
+         * always runs alongside them, and every cover anyone finds tightens the
+         * others' pruning. The first to prove its answer minimum stops the rest.
+         * The list can't be empty or contain PORTFOLIO or BUDGET_PROBES.
+         */
+        std::vector<SolverBackend> portfolio = {
+            SolverBackend::BRANCH_AND_BOUND, SolverBackend::SAT, SolverBackend::MEASURE_AND_CONQUER
+        };
+
+        /* If non-null, searches add the nodes they visit to this as they go. */
+        std::atomic<long long>* nodeCounter = nullptr;
+
+        /* If set, findMinimumCover and findMinimumCoverBy call this with a cover of the
+         * whole network before searching, then again each time they find a smaller one.
+         * It may be called from worker threads, but never from two at once.
+         */
+        CoverCallback onImprovement;
+    };
+
+    /* Everything the solver pipeline learned while running. */
+    struct SolverStats {
+        KernelStats kernel;                        // What preprocessing removed
+        int components = 0;                        // Connected components of the kernel
+        int treeDPComponents = 0;                  // Components solved by tree-decomposition DP
+        int blockCutComponents = 0;                // Components solved block by block
+        SearchStats search;                        // What the searches on the kernel did, summed
+        SatStats sat;                              // What the SAT solves on the kernel did, summed
+        std::map<std::string, int> portfolioWins;  // Races each portfolio member won, by backendName
+        int budgetProbes = 0;                      // Budgets decided by BUDGET_PROBES, or cancelled
+        int settledProbes = 0;                     // Probes cancelled because others settled their budgets
+    };
+
+    /* How much a time-limited solve was able to establish. */
+    enum class SolveStatus {
+        OPTIMAL,    // The cover is proven to be minimum
+        FEASIBLE,   // The cover is valid, but there wasn't time to prove it minimum
+        TIMED_OUT   // Time ran out before any cover was found
+    };
+
+    /* The outcome of a time-limited solve. */
+    struct SolveResult {
+        std::vector<CityId> cover;  // Best cover found; empty if timed out
+        int lowerBound = 0;         // No cover has fewer cities than this
+        SolveStatus status = SolveStatus::TIMED_OUT;
+    };
+
+    /**
+     * Full solver pipeline for the decision problem: kernelizes the network, splits the
+     * kernel into connected components, and solves the components independently (in
+     * parallel when there are several) against the budget left over after forced picks.
+     *
+     * @param graph   The road network.
+     * @param budget  How many cities may hold supplies. Must be nonnegative.
+     * @param cover   An outparameter filled in with the chosen cities if a cover exists.
+     * @param options Solver settings.
+     * @param stats   If non-null, receives statistics about the run.
+     * @return Whether a cover with at most budget cities exists.
+     */
+    bool findCoverWithin(const RoadGraph& graph, int budget, std::vector<CityId>& cover,
+                         const SolverOptions& options = {}, SolverStats* stats = nullptr);
+
+    /**
+     * Full solver pipeline for the optimization problem: kernelizes the network, then
+     * solves each connected component of the kernel by tree-decomposition DP when it's
+     * narrow enough and by the chosen backend otherwise.
+     *
+     * @param graph   The road network.
+     * @param options Solver settings.
+     * @param stats   If non-null, receives statistics about the run.
+     * @return A minimum-size cover.
+     */
+    std::vector<CityId> findMinimumCover(const RoadGraph& graph, const SolverOptions& options = {},
+                                         SolverStats* stats = nullptr);
+
+    /**
+     * Anytime solver pipeline for networks too hard to solve exactly: kernelizes the
+     * network, then improves a greedy cover of the kernel by local search until the
+     * time budget runs out. Each improvement is reported as a cover of the original
+     * network.
+     *
+     * @param graph         The road network.
+     * @param options       Time budget, cancellation flag, and random seed.
+     * @param onImprovement If set, called with the first cover and every better one.
+     * @return The best cover found.
+     */
+    std::vector<CityId> findGoodCover(const RoadGraph& graph, const AnytimeOptions& options = {},
+                                      const CoverCallback& onImprovement = {});
+
+    /**
+     * The optimization pipeline with a hard time limit. Searches and tree-decomposition
+     * DP stop soon after the deadline passes or cancel becomes true, and whatever was
+     * found is returned along with the best lower bound proven on the way.
+     * <p>
+     * The polynomial-time stages don't check the deadline: kernelization, building tree
+     * decompositions and block-cut trees, and the certificates the portfolio and budget
+     * probes start from. On large networks they can carry a solve past the deadline.
+     *
+     * @param graph    The road network.
+     * @param deadline When to give up.
+     * @param cancel   If non-null, the solve gives up soon after this becomes true.
+     * @param options  Solver settings.
+     * @param stats    If non-null, receives statistics about the run.
+     * @return The best cover found, a lower bound, and whether the cover is optimal.
+     */
+    SolveResult findMinimumCoverBy(const RoadGraph& graph, std::chrono::steady_clock::time_point deadline,
+                                   const std::atomic<bool>* cancel = nullptr,
+                                   const SolverOptions& options = {}, SolverStats* stats = nullptr);
+}
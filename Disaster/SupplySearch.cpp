@@ -0,0 +1,1026 @@
+#include "SupplySearch.h"
+#include "CityBitset.h"
+#include "CoverState.h"
+#include "NogoodDatabase.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <queue>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* Lower bound on the number of supplies needed to cover everything not in
+         * covered using only cities in allowed. It's the larger of two admissible bounds:
+         *
+         *  - Each supply covers at most maxDegree + 1 cities.
+         *  - If some uncovered cities have pairwise disjoint sets of allowed covering
+         *    cities, each needs its own supply. We build such a packing greedily.
+         *
+         * Returns a value larger than any budget if some uncovered city can no longer
+         * be covered at all. The packing argument is scratch space.
+         */
+        int coverLowerBound(const vector<CityBitset>& closed, const CityBitset& covered,
+                            const CityBitset& allowed, int numUncovered, int maxDegree,
+                            CityBitset& packing) {
+            int perSupply = maxDegree + 1;
+            int bound = (numUncovered + perSupply - 1) / perSupply;
+
+            packing.clear();
+            int packed = 0;
+            for (CityId city = 0; city < CityId(covered.size()); city++) {
+                if (covered.test(city)) continue;
+
+                /* Does any allowed city in N[city] already appear in the packing? */
+                bool disjoint = true, coverable = false;
+                for (int w = 0; w < packing.numWords(); w++) {
+                    uint64_t options = closed[city].words()[w] & allowed.words()[w];
+                    if (options) coverable = true;
+                    if (options & packing.words()[w]) {
+                        disjoint = false;
+                        break;
+                    }
+                }
+                if (!disjoint) continue;
+                if (!coverable) return covered.size() + 1;
+
+                for (int w = 0; w < packing.numWords(); w++) {
+                    packing.words()[w] |= closed[city].words()[w] & allowed.words()[w];
+                }
+                packed++;
+            }
+
+            return max(bound, packed);
+        }
+
+        /* Between two cities that cover the same uncovered cities, the search keeps the
+         * one with more neighbors, or failing that the smaller id. Any fixed order
+         * would do; this one agrees with the static analysis below, so the static and
+         * dynamic checks never throw out both of a pair.
+         */
+        bool preferred(const RoadGraph& graph, CityId lhs, CityId rhs) {
+            return graph.degree(lhs) != graph.degree(rhs)? graph.degree(lhs) > graph.degree(rhs) : lhs < rhs;
+        }
+
+        /* For each allowed city a, the allowed cities b with N[a] a subset of N[b] that
+         * are preferred to it. Supplies in b always cover everything supplies in a
+         * would, so while b is allowed there's no need to try a. Every such b contains
+         * a in its neighborhood, so only neighbors need checking.
+         */
+        vector<vector<CityId>> staticDominators(const CoverProblem& problem, const vector<CityBitset>& closed) {
+            vector<vector<CityId>> result(problem.graph.numCities());
+            problem.allowed.forEach([&](CityId city) {
+                for (CityId other: problem.graph.neighbors(city)) {
+                    if (problem.allowed.test(other) && closed[city].isSubsetOf(closed[other]) &&
+                        preferred(problem.graph, other, city)) {
+                        result[city].push_back(other);
+                    }
+                }
+            });
+            return result;
+        }
+
+        /* How many allowed cities could cover each city, before the search rules any out. */
+        vector<int> supplierCounts(const CoverProblem& problem, const vector<CityBitset>& closed) {
+            vector<int> result(problem.graph.numCities());
+            for (CityId city = 0; city < CityId(result.size()); city++) {
+                result[city] = closed[city].countAnd(problem.allowed);
+            }
+            return result;
+        }
+
+        /* State shared by every worker taking part in one search. */
+        struct SharedSearch {
+            SharedSearch(const CoverProblem& problem, int bestSize, bool stopAtFirst,
+                         const SearchControl& control)
+                : problem(problem),
+                  closed(closedNeighborhoods(problem.graph)),
+                  dominators(staticDominators(problem, closed)),
+                  suppliers(supplierCounts(problem, closed)),
+                  control(control),
+                  stopAtFirst(stopAtFirst),
+                  depthLimit(min(bestSize, problem.graph.numCities()) + 1),
+                  bestSize(bestSize) {
+                if (control.table) {
+                    table = control.table;
+                } else if (control.tableEntries > 0) {
+                    ownTable.reset(new TranspositionTable(control.tableEntries));
+                    table = ownTable.get();
+                }
+            }
+
+            const CoverProblem& problem;
+            const vector<CityBitset> closed;  // Closed neighborhood of each city
+            const vector<vector<CityId>> dominators;
+            const vector<int> suppliers;      // Allowed cities in each closed neighborhood
+            const SearchControl& control;
+            const bool stopAtFirst;           // Decision version: any cover will do
+            const int depthLimit;             // Frames each worker needs
+
+            /* The incumbent. Workers read bestSize without locking to prune. */
+            atomic<int>  bestSize;            // Only covers strictly smaller are interesting
+            atomic<bool> done{false};         // Solution found (decision) or interrupted
+            atomic<bool> interrupted{false};  // Cancelled, or out of time
+            mutex lock;                       // Guards best and found
+            vector<CityId> best;
+            bool found = false;
+
+            WorkStealingPool* pool = nullptr; // Null for a sequential search
+
+            /* States already proven infeasible; null if the table is turned off. */
+            TranspositionTable* table = nullptr;
+            unique_ptr<TranspositionTable> ownTable;
+        };
+
+        /* A subtree handed off to whichever worker gets to it first. */
+        struct SearchTask {
+            vector<CityId> chosen;  // Supplies placed on the path to the subtree
+            CityBitset allowed;     // Cities the subtree may still use
+        };
+
+        /* Branch-and-bound search for small covers.
+         *
+         * Coverage and the set of cities still allowed to hold supplies live in a
+         * single CoverState that's changed in place and rolled back along its trail,
+         * so a search node doesn't allocate.
+         *
+         * Each node branches on the uncovered city with the fewest allowed cities left
+         * that could cover it, rather than on the first one by id, so the shape of the
+         * tree doesn't depend on how the cities happen to be named.
+         *
+         * When we branch on the cities that could cover some uncovered city u, the i-th
+         * branch forbids the options tried in branches 1 .. i-1: any cover using one of
+         * those was already explored in its own branch.
+         *
+         * Different orders of placing the same supplies reach the same state, so
+         * subtrees that fail are remembered in a transposition table. A state is the
+         * covered set plus the allowed cities that could still cover something; the
+         * table records the largest number of further supplies shown not to suffice.
+         *
+         * A failed subtree also yields a core when the failure doesn't depend on which
+         * cities its ancestors ruled out: a set of uncovered cities that no budget of
+         * supplies could cover (see learnFromBranches). Cores go into a nogood
+         * database and prune every later node that leaves a whole core uncovered,
+         * whatever else that node has covered.
+         *
+         * In a parallel search every worker owns one of these. A worker that's about
+         * to branch on a big enough subproblem while its deque is nearly empty turns
+         * the branches into tasks instead of exploring them itself.
+         */
+        class BranchAndBound {
+        public:
+            /* The engines vector holds one engine per worker, this one included. */
+            BranchAndBound(SharedSearch& shared, vector<unique_ptr<BranchAndBound>>& engines)
+                : mShared(shared),
+                  mEngines(engines),
+                  mGraph(shared.problem.graph),
+                  mClosed(shared.closed),
+                  mState(shared.problem, shared.closed) {
+                int numCities = mGraph.numCities();
+                mOptions.assign(shared.depthLimit, {});
+                mPacking = CityBitset(numCities);
+                mRelevant = CityBitset(numCities);
+                mGain.assign(numCities, 0);
+
+                if (shared.control.nogoodEntries > 0) {
+                    mNogoods.reset(new NogoodDatabase(shared.control.nogoodEntries, numCities));
+                    mCores.assign(shared.depthLimit + 1, { CityBitset(numCities), 0 });
+                }
+            }
+
+            /* Searches the whole tree from the root. */
+            void runRoot(int worker) {
+                mWorker = worker;
+                mState.assign({}, mShared.problem.allowed);
+                search(0);
+                mForced.clear();
+            }
+
+            /* Searches the subtree described by a task. */
+            void runTask(const SearchTask& task, int worker) {
+                mWorker = worker;
+                int depth = int(task.chosen.size());
+                if (depth >= mShared.bestSize.load(memory_order_relaxed)) return;
+
+                mState.assign(task.chosen, task.allowed);
+                search(depth);
+                mForced.clear();
+            }
+
+            SearchStats stats;
+
+        private:
+            SharedSearch& mShared;
+            vector<unique_ptr<BranchAndBound>>& mEngines;
+            const RoadGraph& mGraph;
+            const vector<CityBitset>& mClosed;
+            CoverState mState;                // Supplies on the current path and what they cover
+            vector<vector<CityId>> mOptions;  // Branching scratch space, one per depth
+            CityBitset mPacking;              // Scratch space for the packing bound
+            CityBitset mRelevant;             // Scratch space for transposition keys
+            unique_ptr<NogoodDatabase> mNogoods;  // Null if learning is off
+            vector<Nogood> mCores;            // Core of the node entered at each depth
+            vector<CityId> mForced;           // Cities whose only candidate propagation placed
+            vector<int> mGain;                // Scratch space for ordering options
+            vector<char> mDominated;          // Scratch space for dropDominated
+            int mWorker = 0;
+
+            /* Subproblems get split into tasks only while the local deque is this short. */
+            static const int kSplitQueueLength = 2;
+
+            bool shouldStop() {
+                if (mShared.done.load(memory_order_relaxed)) return true;
+
+                /* Polling the cancel flag and the clock is cheap, but not free; check
+                 * every so often.
+                 */
+                if ((stats.nodes & 255) != 0) return false;
+
+                const SearchControl& control = mShared.control;
+                if (control.nodeCounter) *control.nodeCounter += 256;
+
+                /* Covers other solvers found count as incumbents too, except in the
+                 * decision version, which wants a cover of its own.
+                 */
+                if (control.sharedBest && !mShared.stopAtFirst) {
+                    lowerBestSize(control.sharedBest->load(memory_order_relaxed));
+                    if (mShared.bestSize <= control.knownLowerBound) {
+                        mShared.done = true;
+                        return true;
+                    }
+                }
+
+                if ((control.cancel && control.cancel->load(memory_order_relaxed)) ||
+                    (control.deadline != chrono::steady_clock::time_point::max() &&
+                     chrono::steady_clock::now() >= control.deadline)) {
+                    mShared.interrupted = true;
+                    mShared.done = true;
+                    return true;
+                }
+                return false;
+            }
+
+            /* Everything is covered after depth placements. Offer it as the incumbent. */
+            void record(int depth) {
+                lock_guard<mutex> lock(mShared.lock);
+                if (depth >= mShared.bestSize) return;
+
+                mShared.best = mState.chosen();
+                mShared.found = true;
+                lowerBestSize(depth);
+                stats.improvements++;
+                if (mShared.stopAtFirst || depth <= mShared.control.knownLowerBound) mShared.done = true;
+                if (!mShared.stopAtFirst) publishCover(mShared.control, mShared.best);
+            }
+
+            /* Other workers and solvers may lower the incumbent at the same time. */
+            void lowerBestSize(int size) {
+                int current = mShared.bestSize.load(memory_order_relaxed);
+                while (size < current && !mShared.bestSize.compare_exchange_weak(current, size)) {}
+            }
+
+            int lowerBound() {
+                return coverLowerBound(mClosed, mState.covered(), mState.allowed(),
+                                       mState.numUncovered(), mGraph.maxDegree(), mPacking);
+            }
+
+            /* The table key for the current state. Allowed cities that can't cover
+             * anything new make no difference to the subtree, so they're left out.
+             */
+            StateKey stateKey() {
+                const CityBitset& covered = mState.covered();
+                mRelevant.clear();
+                mState.allowed().forEach([&](CityId city) {
+                    if (!mClosed[city].isSubsetOf(covered)) mRelevant.set(city);
+                });
+                return keyFor(covered, mRelevant);
+            }
+
+            bool shouldSplit(int numUncovered) {
+                return mShared.pool &&
+                       numUncovered >= mShared.control.taskGranularity &&
+                       mShared.pool->queued(mWorker) < kSplitQueueLength;
+            }
+
+            /* Searches the subtree of the current state, with depth supplies placed.
+             * Returns whether it failed with a core, which is then in mCores[depth].
+             */
+            bool search(int depth) {
+                stats.nodes++;
+                if (shouldStop()) return false;
+
+                int entry = depth;
+                size_t forcedBefore = mForced.size();
+                int uncovered;
+                bool learned;
+                if (!propagate(depth, uncovered)) {
+                    stats.deadEnds++;
+                    learned = learnFromDeadEnd(entry, depth, uncovered);
+                } else if (uncovered == -1) {
+                    record(depth);
+                    learned = false;
+                } else {
+                    learned = branch(entry, depth, uncovered);
+                }
+
+                /* Forced placements come back out of the core. */
+                if (learned) learned = liftThroughForced(entry, forcedBefore);
+                mForced.resize(forcedBefore);
+                return learned;
+            }
+
+            /* Tries to cover the given city, the most constrained one, in every way
+             * still allowed. Returns whether the subtree failed with a core, which is
+             * then in mCores[entry].
+             */
+            bool branch(int entry, int depth, int uncovered) {
+                const CityBitset& covered = mState.covered();
+
+                int numUncovered = mState.numUncovered();
+                int budget = mShared.bestSize.load(memory_order_relaxed) - depth - 1;
+                if (lowerBound() > budget) {
+                    stats.boundPrunes++;
+                    return learnFromBound(entry, budget);
+                }
+
+                /* Only covers with fewer than bestSize supplies in total are interesting. */
+                TranspositionTable* table = mShared.table;
+                StateKey key;
+                if (table) {
+                    key = stateKey();
+                    if (table->provesInfeasible(key, budget)) {
+                        stats.tableHits++;
+                        return false;
+                    }
+                    stats.tableMisses++;
+                }
+
+                if (mNogoods) {
+                    if (mNogoods->find(covered, budget, mCores[entry])) {
+                        stats.nogoodHits++;
+                        return true;
+                    }
+                    stats.nogoodMisses++;
+                }
+
+                /* Something allowed in the closed neighborhood of this city has to hold
+                 * supplies, and branching on the city with the fewest such candidates
+                 * keeps the tree narrow near the root. Try the options that cover the
+                 * most new cities first, since they tend to lead to small incumbents
+                 * quickly.
+                 */
+                auto& options = mOptions[depth];
+                options.clear();
+                for (int w = 0; w < covered.numWords(); w++) {
+                    for (uint64_t bits = mClosed[uncovered].words()[w] & mState.allowed().words()[w];
+                         bits != 0; bits &= bits - 1) {
+                        options.push_back(CityId(w * 64 + lowestBit64(bits)));
+                    }
+                }
+                dropDominated(options);
+                for (CityId option: options) {
+                    mGain[option] = mClosed[option].countAndNot(covered);
+                }
+                sort(options.begin(), options.end(), [&](CityId lhs, CityId rhs) {
+                    return mGain[lhs] != mGain[rhs]? mGain[lhs] > mGain[rhs] : lhs < rhs;
+                });
+
+                bool split = shouldSplit(numUncovered);
+                long long tasksBefore = stats.tasks;
+
+                /* A core needs every city that could cover this one to be tried. */
+                bool learning = mNogoods && !split &&
+                                mState.numCandidates(uncovered) == mShared.suppliers[uncovered];
+                if (learning) {
+                    mCores[entry].cities.clear();
+                    mCores[entry].cities.set(uncovered);
+                    mCores[entry].budget = INT_MAX;
+                }
+
+                size_t start = mState.mark();
+                for (CityId option: options) {
+                    size_t before = mState.mark();
+                    mState.place(option);
+
+                    if (split) {
+                        spawn(SearchTask{ mState.chosen(), mState.allowed() });
+                    } else if (search(depth + 1)) {
+                        if (learning) addBranchCore(entry, depth + 1);
+                    } else {
+                        learning = false;
+                    }
+
+                    mState.undo(before);
+                    if (mShared.done) break;
+
+                    /* Later siblings can't use this option; that case is covered. */
+                    mState.forbid(option);
+
+                    /* The incumbent may have improved; recheck before the next sibling.
+                     * Every later sibling would need a negative budget, which nothing
+                     * can meet, so the core stays valid with that budget.
+                     */
+                    if (depth + 1 >= mShared.bestSize.load(memory_order_relaxed)) {
+                        if (learning) mCores[entry].budget = min(mCores[entry].budget, 0);
+                        break;
+                    }
+                }
+                mState.undo(start);
+                if (mShared.done) return false;
+
+                /* Every completion from here was either pruned or recorded, so none has
+                 * fewer than bestSize supplies in total. The incumbent only shrinks, so
+                 * reading it now gives a claim that held throughout. Subtrees that went
+                 * (even partly) to other workers haven't finished yet and can't be stored.
+                 */
+                if (table && stats.tasks == tasksBefore) {
+                    table->storeInfeasible(key, mShared.bestSize.load(memory_order_relaxed) - depth - 1);
+                }
+
+                if (learning) {
+                    long long before = mNogoods->stores();
+                    mNogoods->store(mCores[entry]);
+                    stats.nogoodStores += mNogoods->stores() - before;
+                }
+                return learning;
+            }
+
+            /* Learning from a branch works like resolution. Say every option o for
+             * covering city u failed with a core K_o and budget b_o, and u's options
+             * were all the cities that could ever cover it, less some dominated ones.
+             * Then {u} and all the K_o together need more than min b_o + 1 supplies: a
+             * cover would have to put supplies on some option o (swapping a dominated
+             * option for the one that beats it), and o covers nothing in K_o, which the
+             * remaining supplies can't cover by themselves.
+             */
+            void addBranchCore(int entry, int child) {
+                mCores[entry].cities |= mCores[child].cities;
+                mCores[entry].budget = min(mCores[entry].budget, mCores[child].budget + 1);
+            }
+
+            /* A supply placed because it was the only city that could ever cover some
+             * city c turns a core K with budget b into K + {c} with budget b + 1. If
+             * the search ruled out c's other candidates instead, the core would depend
+             * on that, so nothing is learned.
+             */
+            bool liftThroughForced(int entry, size_t forcedBefore) {
+                for (size_t i = forcedBefore; i < mForced.size(); i++) {
+                    if (mShared.suppliers[mForced[i]] != 1) return false;
+                }
+                for (size_t i = forcedBefore; i < mForced.size(); i++) {
+                    mCores[entry].cities.set(mForced[i]);
+                    mCores[entry].budget++;
+                }
+                return true;
+            }
+
+            /* Propagation stopped at the given city. If nothing could ever cover it, it's
+             * a core by itself; if the budget couldn't reach every uncovered city, any
+             * budget * (maxDegree + 1) + 1 of them are.
+             */
+            bool learnFromDeadEnd(int entry, int depth, int uncovered) {
+                if (!mNogoods) return false;
+
+                Nogood& core = mCores[entry];
+                if (mState.numCandidates(uncovered) == 0) {
+                    if (mShared.suppliers[uncovered] != 0) return false;
+
+                    core.cities.clear();
+                    core.cities.set(uncovered);
+                    core.budget = INT_MAX / 2;
+                    return true;
+                }
+                return learnFromCounting(entry, mShared.bestSize.load(memory_order_relaxed) - depth - 1);
+            }
+
+            /* The degree bound as a core: more uncovered cities than budget supplies can
+             * reach. A negative budget needs no cities at all.
+             */
+            bool learnFromCounting(int entry, int budget) {
+                Nogood& core = mCores[entry];
+                core.cities.clear();
+                core.budget = budget;
+                if (budget < 0) return true;
+
+                long long needed = (long long) budget * (mGraph.maxDegree() + 1) + 1;
+                if (mState.numUncovered() < needed) return false;
+
+                const CityBitset& covered = mState.covered();
+                for (CityId city = 0; needed > 0; city++) {
+                    if (!covered.test(city)) {
+                        core.cities.set(city);
+                        needed--;
+                    }
+                }
+                return true;
+            }
+
+            /* The lower bound pruned this node, but it uses only the cities still
+             * allowed here. A packing of budget + 1 uncovered cities whose candidates
+             * are disjoint even counting every city the problem allows is a core.
+             * Failing that, the degree bound may be one.
+             */
+            bool learnFromBound(int entry, int budget) {
+                if (!mNogoods) return false;
+
+                Nogood& core = mCores[entry];
+                core.cities.clear();
+                core.budget = budget;
+                mPacking.clear();
+
+                const CityBitset& covered = mState.covered();
+                const CityBitset& allowed = mShared.problem.allowed;
+                int packed = 0;
+                for (CityId city = 0; city < CityId(covered.size()) && packed <= budget; city++) {
+                    if (covered.test(city)) continue;
+
+                    bool disjoint = true;
+                    for (int w = 0; w < mPacking.numWords() && disjoint; w++) {
+                        disjoint = !(mClosed[city].words()[w] & allowed.words()[w] & mPacking.words()[w]);
+                    }
+                    if (!disjoint) continue;
+
+                    for (int w = 0; w < mPacking.numWords(); w++) {
+                        mPacking.words()[w] |= mClosed[city].words()[w] & allowed.words()[w];
+                    }
+                    core.cities.set(city);
+                    packed++;
+                }
+                return packed > budget || learnFromCounting(entry, budget);
+            }
+
+            /* Places supplies that every cover extending the current state needs: when
+             * an uncovered city has just one allowed city left that could cover it,
+             * there's nothing to branch on. Repeats until no city is forced, much like
+             * unit propagation in a SAT solver. Placements stay on the trail, so the
+             * caller's undo takes them back along with its own move, and the cities
+             * they were forced by go on mForced.
+             *
+             * Returns false if the state can't lead to a cover smaller than the
+             * incumbent: some city has no candidates left, or the supplies still
+             * affordable can't reach all the uncovered cities even at maxDegree + 1
+             * apiece. Either way, depth is the number of supplies placed so far and
+             * uncovered is the most constrained uncovered city, or -1 if everything is
+             * covered.
+             */
+            bool propagate(int& depth, int& uncovered) {
+                int perSupply = mGraph.maxDegree() + 1;
+                while (true) {
+                    uncovered = mState.mostConstrained();
+                    if (uncovered == -1) return true;
+
+                    int budget = mShared.bestSize.load(memory_order_relaxed) - depth - 1;
+                    if (mState.numCandidates(uncovered) == 0 ||
+                        (long long) budget * perSupply < mState.numUncovered()) {
+                        return false;
+                    }
+                    if (mState.numCandidates(uncovered) > 1) return true;
+
+                    const CityBitset& allowed = mState.allowed();
+                    for (int w = 0; w < allowed.numWords(); w++) {
+                        uint64_t bits = mClosed[uncovered].words()[w] & allowed.words()[w];
+                        if (bits != 0) {
+                            mState.place(CityId(w * 64 + lowestBit64(bits)));
+                            break;
+                        }
+                    }
+                    if (mNogoods) mForced.push_back(CityId(uncovered));
+                    stats.forced++;
+                    depth++;
+                }
+            }
+
+            /* Removes options that some other option beats: everything still uncovered
+             * that the option covers, the other covers too. Any cover using the option
+             * can swap in the other instead, so branching on it can't find anything
+             * smaller. Of equal options, the preferred one stays. The one-time analysis
+             * of closed neighborhoods catches the common cases cheaply; the rest are
+             * checked against the current coverage.
+             */
+            void dropDominated(vector<CityId>& options) {
+                const CityBitset& covered = mState.covered();
+                mDominated.assign(options.size(), false);
+
+                for (size_t i = 0; i < options.size(); i++) {
+                    CityId option = options[i];
+                    for (CityId other: mShared.dominators[option]) {
+                        if (mState.allowed().test(other)) {
+                            mDominated[i] = true;
+                            break;
+                        }
+                    }
+
+                    for (size_t j = 0; j < options.size() && !mDominated[i]; j++) {
+                        CityId other = options[j];
+                        if (j == i || !mClosed[option].isSubsetOf(mClosed[other], covered)) continue;
+                        mDominated[i] = preferred(mGraph, other, option) ||
+                                        !mClosed[other].isSubsetOf(mClosed[option], covered);
+                    }
+                }
+
+                size_t kept = 0;
+                for (size_t i = 0; i < options.size(); i++) {
+                    if (!mDominated[i]) options[kept++] = options[i];
+                }
+                stats.dominated += options.size() - kept;
+                options.resize(kept);
+            }
+
+            /* Queues a subtree for whichever worker gets to it first. */
+            void spawn(SearchTask task) {
+                stats.tasks++;
+                auto* engines = &mEngines;
+                mShared.pool->spawn(mWorker, [engines, task](int worker) {
+                    (*engines)[worker]->runTask(task, worker);
+                });
+            }
+        };
+
+        /* Runs a search to completion, sequentially or on a work-stealing pool. */
+        SearchStats runSearch(SharedSearch& shared) {
+            int threads = shared.control.threads > 0? shared.control.threads : ThreadPool::defaultThreads();
+
+            vector<unique_ptr<BranchAndBound>> engines;
+            for (int i = 0; i < threads; i++) {
+                engines.emplace_back(new BranchAndBound(shared, engines));
+            }
+
+            /* A single thread runs the plain depth-first search, so its results are
+             * deterministic.
+             */
+            SearchStats stats;
+            if (threads == 1) {
+                engines[0]->runRoot(0);
+            } else {
+                WorkStealingPool pool(threads);
+                shared.pool = &pool;
+                pool.run([&](int worker) {
+                    engines[worker]->runRoot(worker);
+                });
+                shared.pool = nullptr;
+                stats.steals = pool.steals();
+            }
+
+            for (const auto& engine: engines) {
+                stats += engine->stats;
+            }
+            stats.interrupted = shared.interrupted;
+            return stats;
+        }
+    }
+
+    CoverProblem::CoverProblem(RoadGraph graph)
+        : graph(std::move(graph)) {
+        mustCover = CityBitset(this->graph.numCities());
+        mustCover.setAll();
+        allowed = mustCover;
+    }
+
+    SearchStats& SearchStats::operator+= (const SearchStats& rhs) {
+        nodes        += rhs.nodes;
+        boundPrunes  += rhs.boundPrunes;
+        improvements += rhs.improvements;
+        tasks        += rhs.tasks;
+        steals       += rhs.steals;
+        tableHits    += rhs.tableHits;
+        tableMisses  += rhs.tableMisses;
+        dominated    += rhs.dominated;
+        forced       += rhs.forced;
+        deadEnds     += rhs.deadEnds;
+        nogoodHits   += rhs.nogoodHits;
+        nogoodMisses += rhs.nogoodMisses;
+        nogoodStores += rhs.nogoodStores;
+        interrupted   = interrupted || rhs.interrupted;
+        return *this;
+    }
+
+    void publishCoverSize(const SearchControl& control, int size) {
+        if (!control.sharedBest) return;
+
+        int current = control.sharedBest->load(memory_order_relaxed);
+        while (size < current && !control.sharedBest->compare_exchange_weak(current, size)) {}
+    }
+
+    void publishCover(const SearchControl& control, const vector<CityId>& cover) {
+        publishCoverSize(control, int(cover.size()));
+        if (control.onImprovement) control.onImprovement(cover);
+    }
+
+    double SearchStats::nogoodHitRate() const {
+        long long lookups = nogoodHits + nogoodMisses;
+        return lookups == 0? 0 : double(nogoodHits) / lookups;
+    }
+
+    int lowerBoundOnCover(const CoverProblem& problem) {
+        CityBitset covered = problem.mustCover;
+        covered.setAll();
+        covered.andNot(problem.mustCover);
+
+        CityBitset packing(problem.graph.numCities());
+        return coverLowerBound(closedNeighborhoods(problem.graph), covered, problem.allowed,
+                               problem.mustCover.count(), problem.graph.maxDegree(), packing);
+    }
+
+    bool findSupplyCover(const CoverProblem& problem, int budget, vector<CityId>& cover,
+                         SearchStats* stats, const SearchControl& control) {
+        cover.clear();
+
+        /* We never need more supplies than there are cities. */
+        SharedSearch shared(problem, min(budget, problem.graph.numCities()) + 1, true, control);
+        SearchStats result = runSearch(shared);
+        if (shared.found) cover = shared.best;
+
+        if (stats) *stats = result;
+        return shared.found;
+    }
+
+    bool findMinimumSupplyCover(const CoverProblem& problem, vector<CityId>& cover,
+                                SearchStats* stats, const SearchControl& control) {
+        /* The greedy cover is the incumbent to beat. If greedy can't cover everything,
+         * nothing can.
+         */
+        if (!greedySupplyCover(problem, cover)) {
+            if (stats) *stats = SearchStats();
+            return false;
+        }
+
+        /* If greedy is over the limit, only covers within the limit are interesting. */
+        bool haveIncumbent = int(cover.size()) <= control.upperLimit;
+        int bestSize = haveIncumbent? int(cover.size()) : control.upperLimit + 1;
+        if (haveIncumbent) publishCover(control, cover);
+        if (haveIncumbent && bestSize <= control.knownLowerBound) {
+            if (stats) *stats = SearchStats();
+            return true;
+        }
+
+        SharedSearch shared(problem, bestSize, false, control);
+        SearchStats result = runSearch(shared);
+        if (shared.found) {
+            cover = shared.best;
+            haveIncumbent = true;
+        }
+
+        if (stats) *stats = result;
+        return haveIncumbent;
+    }
+
+    bool greedySupplyCover(const CoverProblem& problem, vector<CityId>& cover) {
+        CityBitset uncovered = problem.mustCover;
+        cover.clear();
+        return greedyExtendCover(closedNeighborhoods(problem.graph), problem.allowed, uncovered, cover);
+    }
+
+    bool greedyExtendCover(const vector<CityBitset>& closed, const CityBitset& allowed,
+                           CityBitset& uncovered, vector<CityId>& cover) {
+        /* Entries are (gain, -city), so larger gains and then smaller ids come first.
+         * A stored gain may be stale, but never too small.
+         */
+        priority_queue<pair<int, int>> queue;
+        allowed.forEach([&](CityId city) {
+            int gain = closed[city].countAnd(uncovered);
+            if (gain > 0) queue.push({ gain, -int(city) });
+        });
+
+        while (uncovered.any()) {
+            if (queue.empty()) return false;
+
+            CityId city = CityId(-queue.top().second);
+            queue.pop();
+
+            int gain = closed[city].countAnd(uncovered);
+            if (gain == 0) continue;
+
+            /* Stale entry: rescore it and put it back in line. */
+            if (!queue.empty() && make_pair(gain, -int(city)) < queue.top()) {
+                queue.push({ gain, -int(city) });
+                continue;
+            }
+
+            uncovered.andNot(closed[city]);
+            cover.push_back(city);
+        }
+        return true;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("findMinimumSupplyCover matches exhaustive search on small random networks.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(137);
+    for (int trial = 0; trial < 300; trial++) {
+        CoverProblem problem = randomProblem(generator, 12);
+        int numCities = problem.graph.numCities();
+
+        /* Try every subset of cities. */
+        int best = -1;
+        for (int subset = 0; subset < (1 << numCities); subset++) {
+            std::vector<CityId> cities;
+            for (int city = 0; city < numCities; city++) {
+                if (subset & (1 << city)) cities.push_back(CityId(city));
+            }
+            if (isValidCover(problem, cities) && (best == -1 || int(cities.size()) < best)) best = int(cities.size());
+        }
+
+        std::vector<CityId> cover;
+        EXPECT_EQUAL(findMinimumSupplyCover(problem, cover), best != -1);
+        if (best == -1) continue;
+        EXPECT_EQUAL(int(cover.size()), best);
+
+        EXPECT(findSupplyCover(problem, best, cover));
+        if (best > 0) EXPECT(!findSupplyCover(problem, best - 1, cover));
+    }
+}
+
+STUDENT_TEST("Parallel search finds covers of the same size as sequential search.") {
+    using namespace Disaster;
+
+    /* A 7 x 7 grid needs 12 cities. */
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int row = 0; row < 7; row++) {
+        for (int col = 0; col < 7; col++) {
+            CityId id = CityId(names.size());
+            names.push_back(std::to_string(row) + "," + std::to_string(col));
+            if (row > 0) roads.emplace_back(id, id - 7);
+            if (col > 0) roads.emplace_back(id, id - 1);
+        }
+    }
+    CoverProblem grid{RoadGraph(names, roads)};
+
+    SearchControl control;
+    control.threads = 4;
+    control.taskGranularity = 8;
+
+    std::vector<CityId> cover;
+    SearchStats stats;
+    EXPECT(findMinimumSupplyCover(grid, cover, &stats, control));
+    EXPECT_EQUAL(cover.size(), 12);
+    EXPECT_GREATER_THAN(stats.tasks, 0);
+
+    EXPECT(findSupplyCover(grid, 12, cover, nullptr, control));
+    EXPECT(!findSupplyCover(grid, 11, cover, nullptr, control));
+}
+
+STUDENT_TEST("The transposition table prunes repeated states without changing answers.") {
+    using namespace Disaster;
+
+    /* A 6 x 10 grid needs 16 cities, and many placement orders reach the same state. */
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int row = 0; row < 6; row++) {
+        for (int col = 0; col < 10; col++) {
+            CityId id = CityId(names.size());
+            names.push_back(std::to_string(row) + "," + std::to_string(col));
+            if (row > 0) roads.emplace_back(id, id - 10);
+            if (col > 0) roads.emplace_back(id, id - 1);
+        }
+    }
+    CoverProblem grid{RoadGraph(names, roads)};
+
+    SearchControl withoutTable;
+    withoutTable.tableEntries = 0;
+
+    std::vector<CityId> cover;
+    SearchStats plain, cached;
+    EXPECT(findMinimumSupplyCover(grid, cover, &plain, withoutTable));
+    EXPECT_EQUAL(cover.size(), 16);
+    EXPECT_EQUAL(plain.tableHits + plain.tableMisses, 0);
+
+    EXPECT(findMinimumSupplyCover(grid, cover, &cached));
+    EXPECT_EQUAL(cover.size(), 16);
+    EXPECT_GREATER_THAN(cached.tableHits, 0);
+    EXPECT_LESS_THAN(cached.nodes, plain.nodes);
+
+    /* A shared table carries over from one search to the next. */
+    TranspositionTable table(1 << 12);
+    SearchControl shared;
+    shared.table = &table;
+    EXPECT(!findSupplyCover(grid, 15, cover, nullptr, shared));
+    EXPECT_GREATER_THAN(table.stores(), 0);
+    EXPECT(findSupplyCover(grid, 16, cover, nullptr, shared));
+    EXPECT_EQUAL(cover.size(), 16);
+}
+
+STUDENT_TEST("Learned cores prune later subtrees without changing answers.") {
+    using namespace Disaster;
+
+    SearchControl withoutNogoods;
+    withoutNogoods.nogoodEntries = 0;
+
+    /* Sparse random networks, some with cities pre-covered or ruled out. */
+    std::mt19937 generator(89);
+    for (int trial = 0; trial < 100; trial++) {
+        CoverProblem problem{randomNetwork(generator, 10 + trial % 30, 12)};
+        if (trial % 2 == 0) restrictRandomly(generator, problem);
+
+        std::vector<CityId> expected, cover;
+        bool feasible = findMinimumSupplyCover(problem, expected, nullptr, withoutNogoods);
+        EXPECT_EQUAL(findMinimumSupplyCover(problem, cover), feasible);
+        EXPECT_EQUAL(cover.size(), expected.size());
+    }
+
+    /* On a bigger one, cores learned in one subtree cut off many others. */
+    CoverProblem network{randomNetwork(generator, 90, 8)};
+
+    SearchStats plain, learned;
+    std::vector<CityId> expected, cover;
+    EXPECT(findMinimumSupplyCover(network, expected, &plain, withoutNogoods));
+    EXPECT(findMinimumSupplyCover(network, cover, &learned));
+    EXPECT_EQUAL(cover.size(), expected.size());
+    EXPECT_EQUAL(plain.nogoodHits + plain.nogoodMisses, 0);
+    EXPECT_GREATER_THAN(learned.nogoodStores, 0);
+    EXPECT_GREATER_THAN(learned.nogoodHitRate(), 0);
+    EXPECT_LESS_THAN(learned.nodes, plain.nodes);
+}
+
+STUDENT_TEST("Branching on the most constrained city keeps the tree small however cities are numbered.") {
+    using namespace Disaster;
+
+    /* A 7 x 7 grid with its cities numbered in scrambled orders. Branching on the
+     * lowest-numbered uncovered city takes thousands of nodes on most of these.
+     */
+    for (int stride: { 1, 3, 10, 20 }) {
+        std::vector<std::string> names;
+        for (int i = 0; i < 49; i++) names.push_back(std::to_string(i));
+
+        auto id = [&](int row, int col) { return CityId((row * 7 + col) * stride % 49); };
+        std::vector<std::pair<CityId, CityId>> roads;
+        for (int row = 0; row < 7; row++) {
+            for (int col = 0; col < 7; col++) {
+                if (row > 0) roads.emplace_back(id(row, col), id(row - 1, col));
+                if (col > 0) roads.emplace_back(id(row, col), id(row, col - 1));
+            }
+        }
+        CoverProblem grid{RoadGraph(names, roads)};
+
+        SearchControl control;
+        control.tableEntries = 0;
+
+        std::vector<CityId> cover;
+        SearchStats stats;
+        EXPECT(findMinimumSupplyCover(grid, cover, &stats, control));
+        EXPECT_EQUAL(cover.size(), 12);
+        EXPECT_LESS_THAN(stats.nodes, 1000);
+    }
+}
+
+STUDENT_TEST("Forced placements and dead ends are handled without branching.") {
+    using namespace Disaster;
+
+    /* A comb: a spine of ten cities, each with a tooth that can't hold supplies.
+     * Every tooth forces its spine city.
+     */
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int i = 0; i < 10; i++) {
+        names.push_back("Spine" + std::to_string(i));
+        names.push_back("Tooth" + std::to_string(i));
+        roads.emplace_back(CityId(2 * i), CityId(2 * i + 1));
+        if (i > 0) roads.emplace_back(CityId(2 * i - 2), CityId(2 * i));
+    }
+    CoverProblem comb{RoadGraph(names, roads)};
+    for (int i = 0; i < 10; i++) comb.allowed.reset(CityId(2 * i + 1));
+
+    std::vector<CityId> cover;
+    SearchStats stats;
+    EXPECT(findSupplyCover(comb, 10, cover, &stats));
+    EXPECT_EQUAL(cover.size(), 10);
+    EXPECT_EQUAL(stats.forced, 10);
+    EXPECT_EQUAL(stats.nodes, 1);
+
+    /* Nine supplies can't do it, and propagation notices right away. */
+    stats = {};
+    EXPECT(!findSupplyCover(comb, 9, cover, &stats));
+    EXPECT_EQUAL(stats.nodes, 1);
+    EXPECT_EQUAL(stats.deadEnds, 1);
+}
+
+STUDENT_TEST("Dominated options aren't branched on.") {
+    using namespace Disaster;
+
+    /* Supplies at any leaf of a star cover a subset of what the hub covers. */
+    CoverProblem star{RoadGraph({ "A", "B", "C", "D", "E", "Hub" },
+                                { { 0, 5 }, { 1, 5 }, { 2, 5 }, { 3, 5 }, { 4, 5 } })};
+
+    std::vector<CityId> cover;
+    SearchStats stats;
+    EXPECT(findSupplyCover(star, 1, cover, &stats));
+    EXPECT(cover == std::vector<CityId>({ 5 }));
+    EXPECT_EQUAL(stats.dominated, 1);
+    EXPECT_EQUAL(stats.nodes, 2);
+
+    /* With the hub ruled out, the leaves no longer have anything to lose to. */
+    star.allowed.reset(5);
+    EXPECT(findMinimumSupplyCover(star, cover, &stats));
+    EXPECT_EQUAL(cover.size(), 5);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "RoadGraph.h"
+#include "CityBitset.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <vector>
+
+namespace Disaster {
+    /**
+     * A dominating-set instance annotated with which cities still need to be covered
+     * and which cities may hold supplies. A plain road network has every city in both
+     * sets; preprocessing (see Kernel.h) produces instances where some cities are
+     * already covered or have been ruled out as supply locations.
+     */
+    struct CoverProblem {
+        RoadGraph  graph;
+        CityBitset mustCover;  // Cities that must end up covered
+        CityBitset allowed;    // Cities that may hold supplies
+
+        CoverProblem() = default;
+
+        /* The unannotated problem: cover every city, using any city. */
+        explicit CoverProblem(RoadGraph graph);
+    };
+
+    /* Counters describing how much work a search did. */
+    struct SearchStats {
+        long long nodes        = 0;  // Search nodes visited
+        long long boundPrunes  = 0;  // Subtrees cut off by the lower bound
+        long long improvements = 0;  // Times the incumbent solution got smaller
+        long long tasks        = 0;  // Subtrees handed to the work-stealing pool
+        long long steals       = 0;  // Tasks run by a worker other than their creator
+        long long tableHits    = 0;  // Subtrees skipped because the table proved them infeasible
+        long long tableMisses  = 0;  // Table lookups that didn't settle the subtree
+        long long dominated    = 0;  // Branches skipped because another option covers more
+        long long forced       = 0;  // Supplies placed without branching: nothing else could go there
+        long long deadEnds     = 0;  // Nodes abandoned during propagation
+        long long nogoodHits   = 0;  // Subtrees skipped because a learned core was still uncovered
+        long long nogoodMisses = 0;  // Nogood lookups that didn't settle the subtree
+        long long nogoodStores = 0;  // Cores added to the nogood database
+        bool interrupted       = false;  // Stopped early by cancellation or the deadline
+
+        SearchStats& operator+= (const SearchStats& rhs);
+
+        /* Fraction of nogood lookups that pruned the subtree, or 0 if there were none. */
+        double nogoodHitRate() const;
+    };
+
+    /* Knobs for limiting a search from the outside. */
+    struct SearchControl {
+        /* The minimization search only reports covers with at most this many cities. */
+        int upperLimit = INT_MAX;
+
+        /* If non-null, the search gives up soon after this becomes true. */
+        const std::atomic<bool>* cancel = nullptr;
+
+        /* The search also gives up soon after this time. */
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+        /* If non-null, the search adds the nodes it visits to this as it goes, in
+         * batches, so another thread can watch its progress.
+         */
+        std::atomic<long long>* nodeCounter = nullptr;
+
+        /* Worker threads for the search itself; 0 means one per core. With one thread
+         * the search is an ordinary, deterministic depth-first search.
+         */
+        int threads = 1;
+
+        /* In a parallel search, subtrees with fewer uncovered cities than this are
+         * explored by the worker that found them rather than becoming tasks.
+         */
+        int taskGranularity = 24;
+
+        /* Entries in the transposition table the search creates for itself; 0 turns
+         * the table off.
+         */
+        int tableEntries = 1 << 16;
+
+        /* If non-null, the search uses this table instead of making its own. A table
+         * may be reused by any number of searches on the same problem.
+         */
+        TranspositionTable* table = nullptr;
+
+        /* Cores each search worker may keep in its nogood database; 0 turns nogood
+         * learning off.
+         */
+        int nogoodEntries = 1 << 10;
+
+        /* If non-null, the size of the smallest cover any solver working on the same
+         * problem has found, such as the other members of a portfolio. A minimization
+         * only looks for covers smaller than this, and lowers it whenever it finds one.
+         */
+        std::atomic<int>* sharedBest = nullptr;
+
+        /* No cover has fewer cities than this, so a minimization that gets a cover
+         * this small (from anyone) stops there.
+         */
+        int knownLowerBound = 0;
+
+        /* If set, a minimization calls this with each cover it finds that's smaller
+         * than the ones before it, starting from its initial incumbent. Parallel
+         * searches and portfolios may call it from several threads at once.
+         */
+        std::function<void(const std::vector<CityId>&)> onImprovement;
+    };
+
+    /* Lowers control.sharedBest to the given size, if it's set and larger. */
+    void publishCoverSize(const SearchControl& control, int size);
+
+    /* Publishes the cover's size, then hands the cover to control.onImprovement. */
+    void publishCover(const SearchControl& control, const std::vector<CityId>& cover);
+
+    /* An admissible lower bound on the size of any cover, computed without searching. */
+    int lowerBoundOnCover(const CoverProblem& problem);
+
+    /**
+     * Searches for a set of at most budget allowed cities such that every city that
+     * must be covered either is in the set or is adjacent to a city in the set.
+     *
+     * @param problem The instance to solve.
+     * @param budget  How many cities may hold supplies. Must be nonnegative.
+     * @param cover   An outparameter filled in with the chosen cities if a cover exists.
+     * @param stats   If non-null, receives counters describing the search.
+     * @param control Optional cancellation flag and deadline.
+     * @return Whether such a set of cities exists. Returns false if interrupted.
+     */
+    bool findSupplyCover(const CoverProblem& problem, int budget, std::vector<CityId>& cover,
+                         SearchStats* stats = nullptr, const SearchControl& control = {});
+
+    /**
+     * Finds a smallest set of allowed cities that covers every city that must be
+     * covered, using a single branch-and-bound search. The search starts from a greedy
+     * incumbent and prunes any subtree whose lower bound shows it can't beat it.
+     *
+     * @param problem The instance to solve.
+     * @param cover   An outparameter filled in with a minimum-size cover, if any exists.
+     * @param stats   If non-null, receives counters describing the search.
+     * @param control Optional size limit, cancellation flag, and deadline.
+     * @return Whether any cover within the size limit exists. If interrupted, the cover
+     *         is the best one found so far, which may not be minimum.
+     */
+    bool findMinimumSupplyCover(const CoverProblem& problem, std::vector<CityId>& cover,
+                                SearchStats* stats = nullptr, const SearchControl& control = {});
+
+    /**
+     * A quick greedy cover: repeatedly picks the allowed city that covers the most
+     * cities still needing coverage. Returns false if some city can't be covered.
+     */
+    bool greedySupplyCover(const CoverProblem& problem, std::vector<CityId>& cover);
+
+    /**
+     * Finishes a partial cover greedily, picking the allowed city that covers the most
+     * of what's left each time (ties go to the smaller id). Gains only ever shrink, so
+     * candidates wait in a priority queue and are rescored only when they reach the top.
+     *
+     * @param closed    Closed neighborhoods of the cities; see closedNeighborhoods.
+     * @param allowed   Cities that may be picked.
+     * @param uncovered Cities still needing coverage. Cleared as they get covered.
+     * @param cover     The partial cover. Picked cities are appended to it.
+     * @return Whether everything got covered.
+     */
+    bool greedyExtendCover(const std::vector<CityBitset>& closed, const CityBitset& allowed,
+                           CityBitset& uncovered, std::vector<CityId>& cover);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/* Random networks and cover checks shared by the test cases in this directory. */
+namespace Disaster {
+    /* A network of numCities cities where each road is present with the given percent chance. */
+    inline RoadGraph randomNetwork(std::mt19937& generator, int numCities, int density) {
+        std::vector<std::string> names;
+        std::vector<std::pair<CityId, CityId>> roads;
+        for (int i = 0; i < numCities; i++) {
+            names.push_back(std::to_string(i));
+            for (int j = 0; j < i; j++) {
+                if (int(generator() % 100) < density) roads.emplace_back(CityId(i), CityId(j));
+            }
+        }
+        return RoadGraph(names, roads);
+    }
+
+    /* Marks about a quarter of the cities as already covered and about a quarter
+     * as unable to hold supplies, the way kernels do.
+     */
+    inline void restrictRandomly(std::mt19937& generator, CoverProblem& problem) {
+        int numCities = problem.graph.numCities();
+        for (int i = 0; i < numCities / 4; i++) problem.mustCover.reset(CityId(generator() % numCities));
+        for (int i = 0; i < numCities / 4; i++) problem.allowed.reset(CityId(generator() % numCities));
+    }
+
+    /* A network of 1 to maxCities cities where each road is present with a random
+     * chance of up to maxDensity percent. A third of them are restricted as above.
+     */
+    inline CoverProblem randomProblem(std::mt19937& generator, int maxCities, int maxDensity = 40) {
+        int numCities = 1 + int(generator() % maxCities);
+        int density = 1 + int(generator() % maxDensity);
+        CoverProblem problem{randomNetwork(generator, numCities, density)};
+        if (generator() % 3 == 0) restrictRandomly(generator, problem);
+        return problem;
+    }
+
+    /* Whether the cities are all allowed to hold supplies and cover every city that must be covered. */
+    inline bool isValidCover(const CoverProblem& problem, const std::vector<CityId>& cover) {
+        CityBitset covered = problem.mustCover;
+        covered.setAll();
+        covered.andNot(problem.mustCover);
+        auto closed = closedNeighborhoods(problem.graph);
+        for (CityId city: cover) {
+            if (!problem.allowed.test(city)) return false;
+            covered |= closed[city];
+        }
+        return covered.isFull();
+    }
+}
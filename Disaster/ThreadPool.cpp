@@ -0,0 +1,46 @@
+#include "ThreadPool.h"
+using namespace std;
+
+namespace Disaster {
+    int ThreadPool::defaultThreads() {
+        unsigned cores = thread::hardware_concurrency();
+        return cores == 0? 1 : int(cores);
+    }
+
+    ThreadPool::ThreadPool(int numThreads) {
+        if (numThreads <= 0) numThreads = defaultThreads();
+        for (int i = 0; i < numThreads; i++) {
+            mWorkers.emplace_back([this] {
+                workerLoop();
+            });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mLock);
+            mShuttingDown = true;
+        }
+        mReady.notify_all();
+        for (auto& worker: mWorkers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::workerLoop() {
+        while (true) {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(mLock);
+                mReady.wait(lock, [this] {
+                    return mShuttingDown || !mTasks.empty();
+                });
+                if (mTasks.empty()) return;
+
+                task = std::move(mTasks.front());
+                mTasks.pop_front();
+            }
+            task();
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Disaster {
+    /**
+     * A fixed-size pool of worker threads pulling tasks from a shared queue. The
+     * destructor finishes all queued tasks before joining the workers.
+     */
+    class ThreadPool {
+    public:
+        /* Creates a pool with the given number of workers; 0 means one per core. */
+        explicit ThreadPool(int numThreads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator= (const ThreadPool&) = delete;
+
+        int numThreads() const {
+            return int(mWorkers.size());
+        }
+
+        /* Queues a task, returning a future for its result. */
+        template <typename Function>
+        auto submit(Function fn) -> std::future<decltype(fn())> {
+            using Result = decltype(fn());
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+            std::future<Result> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                mTasks.emplace_back([task] { (*task)(); });
+            }
+            mReady.notify_one();
+            return result;
+        }
+
+        /* Number of threads to use when the caller asks for "0 = automatic". */
+        static int defaultThreads();
+
+    private:
+        std::vector<std::thread> mWorkers;
+        std::deque<std::function<void()>> mTasks;
+        std::mutex mLock;
+        std::condition_variable mReady;
+        bool mShuttingDown = false;
+
+        void workerLoop();
+    };
+}
@@ -0,0 +1,131 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* The splitmix64 finalizer: a cheap, well-mixed 64-bit hash step. */
+        uint64_t mix(uint64_t value) {
+            value += 0x9E3779B97F4A7C15ULL;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+            return value ^ (value >> 31);
+        }
+
+        void absorb(const CityBitset& set, uint64_t& hash, uint64_t& check) {
+            for (int w = 0; w < set.numWords(); w++) {
+                hash  = mix(hash  ^ set.words()[w]);
+                check = mix(check + set.words()[w] * 0xD6E8FEB86659FD93ULL);
+            }
+        }
+    }
+
+    StateKey keyFor(const CityBitset& covered, const CityBitset& allowed) {
+        uint64_t hash = 0x243F6A8885A308D3ULL, check = 0x13198A2E03707344ULL;
+        absorb(covered, hash, check);
+        absorb(allowed, hash, check);
+        return { hash, check };
+    }
+
+    TranspositionTable::TranspositionTable(int capacity) {
+        int buckets = max(1, (capacity + kBucketSize - 1) / kBucketSize);
+        mSlots.resize(size_t(buckets) * kBucketSize);
+        mHands.resize(buckets, 0);
+    }
+
+    size_t TranspositionTable::bucketOf(const StateKey& key) const {
+        return size_t(key.hash % mHands.size());
+    }
+
+    bool TranspositionTable::provesInfeasible(const StateKey& key, int budget) {
+        size_t bucket = bucketOf(key);
+        lock_guard<mutex> lock(mStripes[bucket % kNumStripes]);
+
+        for (int i = 0; i < kBucketSize; i++) {
+            Slot& slot = mSlots[bucket * kBucketSize + i];
+            if (slot.budget >= 0 && slot.hash == key.hash && slot.check == key.check) {
+                if (slot.budget >= budget) {
+                    slot.referenced = true;
+                    mHits++;
+                    return true;
+                }
+                break;
+            }
+        }
+        mMisses++;
+        return false;
+    }
+
+    void TranspositionTable::storeInfeasible(const StateKey& key, int budget) {
+        size_t bucket = bucketOf(key);
+        lock_guard<mutex> lock(mStripes[bucket % kNumStripes]);
+        Slot* slots = &mSlots[bucket * kBucketSize];
+        mStores++;
+
+        /* Same state already present? Keep the stronger claim. */
+        for (int i = 0; i < kBucketSize; i++) {
+            if (slots[i].budget >= 0 && slots[i].hash == key.hash && slots[i].check == key.check) {
+                slots[i].budget = max(slots[i].budget, budget);
+                slots[i].referenced = true;
+                return;
+            }
+        }
+
+        /* Otherwise take an empty slot, or sweep the clock hand until we find a slot
+         * that hasn't been used since the hand last passed it.
+         */
+        Slot* victim = nullptr;
+        for (int i = 0; i < kBucketSize && !victim; i++) {
+            if (slots[i].budget < 0) victim = &slots[i];
+        }
+        while (!victim) {
+            Slot& candidate = slots[mHands[bucket]];
+            mHands[bucket] = (mHands[bucket] + 1) % kBucketSize;
+
+            if (candidate.referenced) {
+                candidate.referenced = false;
+            } else {
+                victim = &candidate;
+                mEvictions++;
+            }
+        }
+
+        victim->hash = key.hash;
+        victim->check = key.check;
+        victim->budget = budget;
+        victim->referenced = false;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("TranspositionTable answers budget queries and evicts when full.") {
+    using namespace Disaster;
+
+    TranspositionTable table(4);
+    CityBitset covered(10), allowed(10);
+    allowed.setAll();
+
+    StateKey key = keyFor(covered, allowed);
+    EXPECT(!table.provesInfeasible(key, 0));
+
+    table.storeInfeasible(key, 2);
+    EXPECT(table.provesInfeasible(key, 2));
+    EXPECT(table.provesInfeasible(key, 1));
+    EXPECT(!table.provesInfeasible(key, 3));
+    EXPECT_EQUAL(table.hits(), 2);
+    EXPECT_EQUAL(table.misses(), 2);
+
+    /* A different coverage state is a different key. */
+    covered.set(3);
+    EXPECT(!table.provesInfeasible(keyFor(covered, allowed), 0));
+
+    /* Overfill the single bucket; something has to go. */
+    for (int city = 0; city < 10; city++) {
+        covered.set(city);
+        table.storeInfeasible(keyFor(covered, allowed), 1);
+    }
+    EXPECT_GREATER_THAN(table.evictions(), 0);
+}
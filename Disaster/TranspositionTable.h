@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CityBitset.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Disaster {
+    /* A 128-bit fingerprint of a search state. */
+    struct StateKey {
+        std::uint64_t hash  = 0;  // Picks the bucket
+        std::uint64_t check = 0;  // Independent hash, guards against bucket collisions
+    };
+
+    /* Fingerprints the pair (covered, allowed). */
+    StateKey keyFor(const CityBitset& covered, const CityBitset& allowed);
+
+    /**
+     * A bounded-memory cache of search states already proven infeasible. Each entry
+     * records that from a given state (which cities are covered, which may still hold
+     * supplies) there is no cover using budget or fewer additional supplies. A later
+     * visit to the same state with that budget or less can be pruned immediately.
+     * <p>
+     * The table is set-associative: each fingerprint maps to a small bucket, and a full
+     * bucket evicts with the clock (second-chance) policy, so recently useful entries
+     * survive. Buckets are guarded by striped locks, so one table can be shared by all
+     * workers of a parallel search, and by successive searches on the same instance.
+     */
+    class TranspositionTable {
+    public:
+        /* Creates a table with room for roughly the given number of entries. */
+        explicit TranspositionTable(int capacity);
+
+        /* Whether the state is known to have no completion within budget supplies. */
+        bool provesInfeasible(const StateKey& key, int budget);
+
+        /* Records that the state has no completion within budget supplies. */
+        void storeInfeasible(const StateKey& key, int budget);
+
+        int capacity() const {
+            return int(mSlots.size());
+        }
+
+        long long hits()      const { return mHits; }
+        long long misses()    const { return mMisses; }
+        long long stores()    const { return mStores; }
+        long long evictions() const { return mEvictions; }
+
+    private:
+        static const int kBucketSize = 4;
+        static const int kNumStripes = 64;
+
+        struct Slot {
+            std::uint64_t hash  = 0;
+            std::uint64_t check = 0;
+            int  budget = -1;           // -1 marks an empty slot
+            bool referenced = false;    // Clock bit
+        };
+
+        std::vector<Slot> mSlots;
+        std::vector<unsigned char> mHands;  // Clock hand per bucket
+        std::mutex mStripes[kNumStripes];
+        std::atomic<long long> mHits{0}, mMisses{0}, mStores{0}, mEvictions{0};
+
+        std::size_t bucketOf(const StateKey& key) const;
+    };
+}
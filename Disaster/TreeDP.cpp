@@ -0,0 +1,362 @@
+#include "TreeDP.h"
+#include "CityBitset.h"
+#include <algorithm>
+#include <climits>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* What a bag city looks like to the part of the network processed so far. The
+         * uncovered state promises nothing, so a table entry for it is never larger
+         * than the same entry with the city covered.
+         */
+        enum State {
+            UNCOVERED = 0,  // No supplies, and not necessarily covered yet
+            COVERED   = 1,  // No supplies, but covered by supplies already placed
+            SUPPLIED  = 2   // Holds supplies
+        };
+
+        const int kInfinity = INT_MAX / 4;
+
+        /* table[index] is the fewest supplies placed so far that are consistent with
+         * the bag states encoded by index, base 3, one digit per bag city.
+         */
+        using Table = vector<int>;
+
+        /* How a child's table is brought up to its parent's bag. */
+        struct Lift {
+            Table forgotten;                    // Child's table with the child's city forgotten
+            vector<vector<CityId>> bags;        // Bag after each city is introduced
+            vector<int> positions;              // Where that city landed in the bag
+            Table table;                        // Result, over the parent's bag
+        };
+
+        /* Dynamic programming over the decomposition. Node tables are built children
+         * first: each child's table has its own city forgotten, then the parent's other
+         * cities introduced, and then the children of a node are joined. That's the
+         * nice tree decomposition, run one step at a time without building it.
+         */
+        class TreeDP {
+        public:
+            TreeDP(const CoverProblem& problem, const TreeDecomposition& decomposition)
+                : mProblem(problem),
+                  mDecomposition(decomposition),
+                  mClosed(closedNeighborhoods(problem.graph)) {
+                int largest = 0;
+                for (const auto& bag: decomposition.bags) largest = max(largest, int(bag.size()));
+                mPow3.push_back(1);
+                for (int i = 0; i <= largest; i++) mPow3.push_back(mPow3.back() * 3);
+            }
+
+            bool solve(vector<CityId>& cover, const SearchControl& control) {
+                int numNodes = mDecomposition.numNodes();
+                mTables.assign(numNodes, {});
+
+                for (int node = 0; node < numNodes; node++) {
+                    /* A node's table takes up to 3^(width + 1) steps per child, so
+                     * checking once per node is often enough.
+                     */
+                    if ((control.cancel && control.cancel->load(memory_order_relaxed)) ||
+                        (control.deadline != chrono::steady_clock::time_point::max() &&
+                         chrono::steady_clock::now() >= control.deadline)) {
+                        interrupted = true;
+                        return false;
+                    }
+
+                    const auto& children = mDecomposition.children[node];
+                    if (children.empty()) {
+                        mTables[node] = lift(-1, node).table;
+                        continue;
+                    }
+
+                    Table joined = lift(children[0], node).table;
+                    for (size_t i = 1; i < children.size(); i++) {
+                        joined = join(joined, lift(children[i], node).table, mDecomposition.bags[node]);
+                    }
+                    mTables[node] = std::move(joined);
+                }
+
+                /* Each root's bag is just its own city. Forget it and walk back down. */
+                cover.clear();
+                for (int node = 0; node < numNodes; node++) {
+                    if (mDecomposition.parent[node] != -1) continue;
+
+                    int state = bestState(mTables[node], 0, 0, mDecomposition.vertex[node]);
+                    if (state < 0) return false;
+                    traceback(node, state, cover);
+                }
+                sort(cover.begin(), cover.end());
+                return true;
+            }
+
+            bool interrupted = false;
+
+        private:
+            const CoverProblem& mProblem;
+            const TreeDecomposition& mDecomposition;
+            const vector<CityBitset> mClosed;
+            vector<int> mPow3;
+            vector<Table> mTables;  // mTables[node] is over mDecomposition.bags[node]
+
+            int digit(int index, int position) const {
+                return index / mPow3[position] % 3;
+            }
+
+            /* The index with a digit for state inserted at position. */
+            int withDigit(int index, int position, int state) const {
+                return index % mPow3[position] + state * mPow3[position] +
+                       index / mPow3[position] * mPow3[position + 1];
+            }
+
+            /* The entry in the table before bag[position] was introduced that the given
+             * entry comes from, plus the supplies introducing it costs. Returns -1 if
+             * the states are inconsistent.
+             */
+            int introduceSource(const vector<CityId>& bag, int position, int index, int& cost) const {
+                CityId city = bag[position];
+                int state = digit(index, position);
+                int source = index % mPow3[position] + index / mPow3[position + 1] * mPow3[position];
+                cost = 0;
+
+                if (state == SUPPLIED) {
+                    if (!mProblem.allowed.test(city)) return -1;
+                    cost = 1;
+
+                    /* Neighbors that are covered may as well have been uncovered before. */
+                    for (int i = 0; i < int(bag.size()); i++) {
+                        if (i != position && mClosed[city].test(bag[i]) && digit(index, i) == COVERED) {
+                            source -= mPow3[i < position? i : i - 1];
+                        }
+                    }
+                } else if (state == COVERED) {
+                    /* No processed city outside the bag touches a newly introduced one. */
+                    bool supplied = false;
+                    for (int i = 0; i < int(bag.size()) && !supplied; i++) {
+                        supplied = i != position && mClosed[city].test(bag[i]) && digit(index, i) == SUPPLIED;
+                    }
+                    if (!supplied) return -1;
+                }
+                return source;
+            }
+
+            Table introduce(const Table& table, const vector<CityId>& bag, int position) const {
+                Table result(mPow3[bag.size()], kInfinity);
+                for (int index = 0; index < int(result.size()); index++) {
+                    int cost;
+                    int source = introduceSource(bag, position, index, cost);
+                    if (source >= 0 && table[source] < kInfinity) result[index] = table[source] + cost;
+                }
+                return result;
+            }
+
+            /* The cheapest state bag[position] can be in when it leaves the bag, or -1
+             * if none works. Cities that must be covered can't leave uncovered.
+             */
+            int bestState(const Table& table, int index, int position, CityId city) const {
+                int best = -1, bestCost = kInfinity;
+                for (int state: { SUPPLIED, COVERED, UNCOVERED }) {
+                    if (state == UNCOVERED && mProblem.mustCover.test(city)) continue;
+
+                    int cost = table[withDigit(index, position, state)];
+                    if (cost < bestCost) {
+                        best = state;
+                        bestCost = cost;
+                    }
+                }
+                return best;
+            }
+
+            Table forget(const Table& table, const vector<CityId>& bag, int position) const {
+                Table result(mPow3[bag.size() - 1], kInfinity);
+                for (int index = 0; index < int(result.size()); index++) {
+                    int state = bestState(table, index, position, bag[position]);
+                    if (state >= 0) result[index] = table[withDigit(index, position, state)];
+                }
+                return result;
+            }
+
+            /* Calls fn(lhsIndex, rhsIndex) for every way of splitting the entry index of
+             * a join: cities covered in the result must be covered on at least one side,
+             * and since uncovered entries are never worse, exactly one side suffices.
+             */
+            template <typename Callback> void forEachSplit(int index, int bagSize, Callback fn) const {
+                int coveredDigits[32], numCovered = 0, coveredTotal = 0;
+                for (int i = 0; i < bagSize; i++) {
+                    if (digit(index, i) == COVERED) {
+                        coveredDigits[numCovered++] = mPow3[i];
+                        coveredTotal += mPow3[i];
+                    }
+                }
+                for (int mask = 0; mask < (1 << numCovered); mask++) {
+                    int rhsCovered = 0;
+                    for (int i = 0; i < numCovered; i++) {
+                        if (mask & (1 << i)) rhsCovered += coveredDigits[i];
+                    }
+                    if (fn(index - rhsCovered, index - (coveredTotal - rhsCovered))) return;
+                }
+            }
+
+            int suppliedCount(int index, int bagSize) const {
+                int count = 0;
+                for (int i = 0; i < bagSize; i++) {
+                    if (digit(index, i) == SUPPLIED) count++;
+                }
+                return count;
+            }
+
+            Table join(const Table& lhs, const Table& rhs, const vector<CityId>& bag) const {
+                int bagSize = int(bag.size());
+                Table result(lhs.size(), kInfinity);
+                for (int index = 0; index < int(result.size()); index++) {
+                    int shared = suppliedCount(index, bagSize);
+                    int& best = result[index];
+                    forEachSplit(index, bagSize, [&](int left, int right) {
+                        if (lhs[left] < kInfinity && rhs[right] < kInfinity) {
+                            best = min(best, lhs[left] + rhs[right] - shared);
+                        }
+                        return false;
+                    });
+                }
+                return result;
+            }
+
+            /* Brings the table of child (or an empty table, if child is -1) up to the
+             * bag of node.
+             */
+            Lift lift(int child, int node) const {
+                Lift result;
+                vector<CityId> bag;
+                if (child == -1) {
+                    result.forgotten = { 0 };
+                } else {
+                    bag = mDecomposition.bags[child];
+                    int position = int(find(bag.begin(), bag.end(), mDecomposition.vertex[child]) - bag.begin());
+                    result.forgotten = forget(mTables[child], bag, position);
+                    bag.erase(bag.begin() + position);
+                }
+
+                result.table = result.forgotten;
+                for (CityId city: mDecomposition.bags[node]) {
+                    if (binary_search(bag.begin(), bag.end(), city)) continue;
+
+                    int position = int(lower_bound(bag.begin(), bag.end(), city) - bag.begin());
+                    bag.insert(bag.begin() + position, city);
+                    result.table = introduce(result.table, bag, position);
+                    result.bags.push_back(bag);
+                    result.positions.push_back(position);
+                }
+                return result;
+            }
+
+            /* Recovers the supplies behind entry index of the given node's table. */
+            void traceback(int root, int rootIndex, vector<CityId>& cover) const {
+                vector<pair<int, int>> pending = { { root, rootIndex } };
+                while (!pending.empty()) {
+                    int node = pending.back().first, index = pending.back().second;
+                    pending.pop_back();
+
+                    const auto& bag = mDecomposition.bags[node];
+                    int bagSize = int(bag.size());
+                    int own = int(find(bag.begin(), bag.end(), mDecomposition.vertex[node]) - bag.begin());
+                    if (digit(index, own) == SUPPLIED) cover.push_back(mDecomposition.vertex[node]);
+
+                    const auto& children = mDecomposition.children[node];
+                    if (children.empty()) continue;
+
+                    /* Redo the joins, then peel them off from the last one back. */
+                    vector<Lift> lifts;
+                    vector<Table> joined;
+                    for (size_t i = 0; i < children.size(); i++) {
+                        lifts.push_back(lift(children[i], node));
+                        joined.push_back(i == 0? lifts[0].table : join(joined.back(), lifts[i].table, bag));
+                    }
+
+                    for (size_t i = children.size() - 1; i > 0; i--) {
+                        int target = joined[i][index], shared = suppliedCount(index, bagSize);
+                        int next = -1, childIndex = -1;
+                        forEachSplit(index, bagSize, [&](int left, int right) {
+                            const Table& lhs = joined[i - 1];
+                            const Table& rhs = lifts[i].table;
+                            if (lhs[left] < kInfinity && rhs[right] < kInfinity &&
+                                lhs[left] + rhs[right] - shared == target) {
+                                next = left;
+                                childIndex = right;
+                                return true;
+                            }
+                            return false;
+                        });
+                        pending.push_back({ children[i], unlift(children[i], lifts[i], childIndex) });
+                        index = next;
+                    }
+                    pending.push_back({ children[0], unlift(children[0], lifts[0], index) });
+                }
+            }
+
+            /* The entry of the child's own table that an entry of its lifted table came from. */
+            int unlift(int child, const Lift& lifted, int index) const {
+                for (int step = int(lifted.bags.size()) - 1; step >= 0; step--) {
+                    int cost;
+                    index = introduceSource(lifted.bags[step], lifted.positions[step], index, cost);
+                }
+
+                const auto& bag = mDecomposition.bags[child];
+                int position = int(find(bag.begin(), bag.end(), mDecomposition.vertex[child]) - bag.begin());
+                int state = bestState(mTables[child], index, position, bag[position]);
+                return withDigit(index, position, state);
+            }
+        };
+    }
+
+    bool treeDPSupplyCover(const CoverProblem& problem, const TreeDecomposition& decomposition,
+                           vector<CityId>& cover, SearchStats* stats, const SearchControl& control) {
+        TreeDP dp(problem, decomposition);
+        bool found = dp.solve(cover, control);
+
+        if (stats) {
+            *stats = SearchStats();
+            stats->interrupted = dp.interrupted;
+        }
+        return found;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+#include "TestNetworks.h"
+
+STUDENT_TEST("treeDPSupplyCover agrees with branch and bound on random sparse networks.") {
+    using namespace Disaster;
+
+    std::mt19937 generator(271);
+    for (int trial = 0; trial < 200; trial++) {
+        CoverProblem problem = randomProblem(generator, 30, 8);
+
+        std::vector<CityId> expected, cover;
+        bool feasible = findMinimumSupplyCover(problem, expected);
+        EXPECT_EQUAL(treeDPSupplyCover(problem, treeDecomposition(problem.graph), cover), feasible);
+        if (!feasible) continue;
+        EXPECT_EQUAL(cover.size(), expected.size());
+        EXPECT(isValidCover(problem, cover));
+    }
+}
+
+STUDENT_TEST("treeDPSupplyCover stops when cancelled.") {
+    using namespace Disaster;
+
+    RoadGraph line({ "A", "B", "C", "D" }, { { 0, 1 }, { 1, 2 }, { 2, 3 } });
+    CoverProblem problem(line);
+    std::vector<CityId> cover;
+    SearchStats stats;
+
+    std::atomic<bool> cancel(true);
+    SearchControl control;
+    control.cancel = &cancel;
+    EXPECT(!treeDPSupplyCover(problem, treeDecomposition(line), cover, &stats, control));
+    EXPECT(stats.interrupted);
+
+    cancel = false;
+    EXPECT(treeDPSupplyCover(problem, treeDecomposition(line), cover, &stats, control));
+    EXPECT(!stats.interrupted);
+    EXPECT_EQUAL(cover.size(), 2);
+}
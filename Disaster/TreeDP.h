@@ -0,0 +1,30 @@
+#pragma once
+
+#include "SupplySearch.h"
+#include "TreeDecomposition.h"
+#include <vector>
+
+namespace Disaster {
+    /* Widths up to this are solved by dynamic programming by default. Tables have
+     * 3^(width + 1) entries.
+     */
+    const int kDefaultTreeDPWidth = 8;
+
+    /**
+     * Finds a minimum cover by dynamic programming over a tree decomposition. Every
+     * city in a bag is in one of three states: holding supplies, covered by supplies
+     * already placed, or not yet covered. The work is linear in the number of cities
+     * and exponential only in the width, so this is fast on sparse, tree-like road
+     * networks no matter how many cities they have.
+     *
+     * @param problem       The instance to solve.
+     * @param decomposition A tree decomposition of the instance's road network.
+     * @param cover         An outparameter filled in with a minimum-size cover.
+     * @param stats         If non-null, records whether the DP was interrupted.
+     * @param control       Optional cancellation flag and deadline, checked between nodes.
+     * @return Whether any cover exists. Returns false if interrupted.
+     */
+    bool treeDPSupplyCover(const CoverProblem& problem, const TreeDecomposition& decomposition,
+                           std::vector<CityId>& cover, SearchStats* stats = nullptr,
+                           const SearchControl& control = {});
+}
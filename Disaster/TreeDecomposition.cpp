@@ -0,0 +1,157 @@
+#include "TreeDecomposition.h"
+#include "CityBitset.h"
+#include <algorithm>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* Roads that eliminating city would add between its remaining neighbors. */
+        int fillIn(const vector<CityBitset>& adjacent, CityId city) {
+            int missing = 0;
+            vector<CityId> neighbors = adjacent[city].toVector();
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                /* Pairs (i, j) with j > i that aren't already adjacent. */
+                int present = 0;
+                for (size_t j = i + 1; j < neighbors.size(); j++) {
+                    if (adjacent[neighbors[i]].test(neighbors[j])) present++;
+                }
+                missing += int(neighbors.size() - i - 1) - present;
+            }
+            return missing;
+        }
+    }
+
+    TreeDecomposition eliminationDecomposition(const RoadGraph& graph, EliminationHeuristic heuristic,
+                                               int maxWidth) {
+        int numCities = graph.numCities();
+        TreeDecomposition result;
+        result.width = numCities == 0? -1 : 0;
+
+        /* Adjacency of the graph with eliminated cities removed and fill roads added. */
+        vector<CityBitset> adjacent(numCities, CityBitset(numCities));
+        for (CityId city = 0; city < CityId(numCities); city++) {
+            for (CityId neighbor: graph.neighbors(city)) adjacent[city].set(neighbor);
+        }
+
+        CityBitset alive(numCities);
+        alive.setAll();
+        vector<int> nodeOf(numCities, -1);
+
+        for (int step = 0; step < numCities; step++) {
+            /* Pick the city to eliminate, breaking ties by degree and then by id. */
+            CityId best = 0;
+            int bestScore = INT_MAX, bestDegree = INT_MAX;
+            alive.forEach([&](CityId city) {
+                int degree = adjacent[city].count();
+                if (heuristic == EliminationHeuristic::MIN_DEGREE && degree >= bestDegree) return;
+
+                int score = heuristic == EliminationHeuristic::MIN_FILL? fillIn(adjacent, city) : degree;
+                if (score < bestScore || (score == bestScore && degree < bestDegree)) {
+                    best = city;
+                    bestScore = score;
+                    bestDegree = degree;
+                }
+            });
+
+            vector<CityId> neighbors = adjacent[best].toVector();
+            if (int(neighbors.size()) > maxWidth) {
+                result = TreeDecomposition();
+                result.width = int(neighbors.size());
+                return result;
+            }
+            result.width = max(result.width, int(neighbors.size()));
+
+            /* Turn the remaining neighbors into a clique, then drop the city. */
+            for (CityId u: neighbors) {
+                adjacent[u] |= adjacent[best];
+                adjacent[u].reset(u);
+                adjacent[u].reset(best);
+            }
+            alive.reset(best);
+
+            vector<CityId> bag = neighbors;
+            bag.push_back(best);
+            sort(bag.begin(), bag.end());
+
+            nodeOf[best] = step;
+            result.vertex.push_back(best);
+            result.bags.push_back(bag);
+            result.parent.push_back(-1);
+        }
+
+        /* Every city in a bag other than the node's own is eliminated later, and the
+         * first of them is the parent.
+         */
+        result.children.resize(numCities);
+        for (int node = 0; node < numCities; node++) {
+            int parent = INT_MAX;
+            for (CityId city: result.bags[node]) {
+                if (city != result.vertex[node]) parent = min(parent, nodeOf[city]);
+            }
+            if (parent != INT_MAX) {
+                result.parent[node] = parent;
+                result.children[parent].push_back(node);
+            }
+        }
+        return result;
+    }
+
+    TreeDecomposition treeDecomposition(const RoadGraph& graph, int maxWidth) {
+        TreeDecomposition best = eliminationDecomposition(graph, EliminationHeuristic::MIN_DEGREE, maxWidth);
+        bool fits = best.numNodes() == graph.numCities();
+        if (fits && best.width <= 1) return best;
+
+        /* Min-fill usually does at least as well but is slower, so it only has to
+         * finish if it beats min-degree.
+         */
+        int limit = fits? best.width - 1 : maxWidth;
+        TreeDecomposition byFill = eliminationDecomposition(graph, EliminationHeuristic::MIN_FILL, limit);
+        return byFill.numNodes() == graph.numCities()? byFill : best;
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("Tree decompositions cover every road and respect the width limit.") {
+    using namespace Disaster;
+
+    /* A 4 x 5 grid has treewidth 4. */
+    std::vector<std::string> names;
+    std::vector<std::pair<CityId, CityId>> roads;
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 5; col++) {
+            CityId id = CityId(names.size());
+            names.push_back(std::to_string(row) + "," + std::to_string(col));
+            if (row > 0) roads.emplace_back(id, id - 5);
+            if (col > 0) roads.emplace_back(id, id - 1);
+        }
+    }
+    RoadGraph grid(names, roads);
+
+    TreeDecomposition decomposition = treeDecomposition(grid);
+    EXPECT_EQUAL(decomposition.numNodes(), grid.numCities());
+    EXPECT_GREATER_THAN_OR_EQUAL_TO(decomposition.width, 4);
+    EXPECT_LESS_THAN_OR_EQUAL_TO(decomposition.width, 5);
+
+    /* Every road lies inside some bag, and parents come after children. */
+    for (auto road: roads) {
+        bool inside = false;
+        for (const auto& bag: decomposition.bags) {
+            if (std::count(bag.begin(), bag.end(), road.first) &&
+                std::count(bag.begin(), bag.end(), road.second)) inside = true;
+        }
+        EXPECT(inside);
+    }
+    for (int node = 0; node < decomposition.numNodes(); node++) {
+        EXPECT(decomposition.parent[node] == -1 || decomposition.parent[node] > node);
+    }
+
+    /* A path is a tree, and a too-tight limit gives up. */
+    RoadGraph path({ "A", "B", "C", "D" }, { { 0, 1 }, { 1, 2 }, { 2, 3 } });
+    EXPECT_EQUAL(treeDecomposition(path).width, 1);
+    TreeDecomposition tooWide = treeDecomposition(grid, 2);
+    EXPECT_EQUAL(tooWide.numNodes(), 0);
+    EXPECT_GREATER_THAN(tooWide.width, 2);
+}
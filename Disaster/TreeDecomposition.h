@@ -0,0 +1,44 @@
+#pragma once
+
+#include "RoadGraph.h"
+#include <climits>
+#include <vector>
+
+namespace Disaster {
+    /* Rules for picking the next city to eliminate. */
+    enum class EliminationHeuristic {
+        MIN_DEGREE,  // Fewest remaining neighbors
+        MIN_FILL     // Fewest roads added between remaining neighbors
+    };
+
+    /**
+     * A tree decomposition built from an elimination ordering. Node i eliminates the
+     * city vertex[i]; its bag holds that city plus the neighbors it still had when it
+     * was eliminated. The parent of a node is the node of the earliest-eliminated city
+     * in its bag (other than its own), so parents always come after their children and
+     * iterating nodes in order visits every subtree before its root.
+     */
+    struct TreeDecomposition {
+        std::vector<CityId> vertex;              // City eliminated at each node
+        std::vector<std::vector<CityId>> bags;   // Sorted bag of each node
+        std::vector<int> parent;                 // Parent node, or -1 for a root
+        std::vector<std::vector<int>> children;  // Child nodes of each node
+        int width = -1;                          // Largest bag size minus one
+
+        int numNodes() const {
+            return int(vertex.size());
+        }
+    };
+
+    /**
+     * Builds a tree decomposition by greedily eliminating cities with the given
+     * heuristic. If some bag would have more than maxWidth + 1 cities the construction
+     * stops early and returns a decomposition with no nodes whose width is still set
+     * to the width reached, which is more than maxWidth.
+     */
+    TreeDecomposition eliminationDecomposition(const RoadGraph& graph, EliminationHeuristic heuristic,
+                                               int maxWidth = INT_MAX);
+
+    /* The narrower of the min-degree and min-fill decompositions. */
+    TreeDecomposition treeDecomposition(const RoadGraph& graph, int maxWidth = INT_MAX);
+}
@@ -0,0 +1,133 @@
+#include "WorkStealingPool.h"
+#include "ThreadPool.h"
+#include <thread>
+using namespace std;
+
+namespace Disaster {
+    namespace {
+        /* How many times an idle worker looks for work before going to sleep. */
+        const int kIdleSpins = 64;
+    }
+
+    WorkStealingPool::WorkStealingPool(int numThreads) {
+        if (numThreads <= 0) numThreads = ThreadPool::defaultThreads();
+        for (int i = 0; i < numThreads; i++) {
+            mWorkers.emplace_back(new Worker());
+        }
+    }
+
+    void WorkStealingPool::run(Task root) {
+        mSteals = 0;
+        mPending = 1;
+        mQueued = 1;
+        mWorkers[0]->tasks.push_back(std::move(root));
+
+        vector<thread> threads;
+        for (int i = 1; i < numThreads(); i++) {
+            threads.emplace_back([this, i] {
+                workerLoop(i);
+            });
+        }
+        workerLoop(0);
+
+        for (auto& thread: threads) {
+            thread.join();
+        }
+    }
+
+    void WorkStealingPool::spawn(int worker, Task task) {
+        mPending++;
+        {
+            lock_guard<mutex> lock(mWorkers[worker]->lock);
+            mWorkers[worker]->tasks.push_back(std::move(task));
+            mQueued++;
+        }
+
+        /* Taking the lock orders this after any sleeper's last look at mQueued. */
+        { lock_guard<mutex> lock(mIdleLock); }
+        mIdle.notify_one();
+    }
+
+    int WorkStealingPool::queued(int worker) {
+        lock_guard<mutex> lock(mWorkers[worker]->lock);
+        return int(mWorkers[worker]->tasks.size());
+    }
+
+    bool WorkStealingPool::popLocal(int worker, Task& task) {
+        lock_guard<mutex> lock(mWorkers[worker]->lock);
+        if (mWorkers[worker]->tasks.empty()) return false;
+
+        task = std::move(mWorkers[worker]->tasks.back());
+        mWorkers[worker]->tasks.pop_back();
+        return true;
+    }
+
+    bool WorkStealingPool::steal(int thief, Task& task) {
+        for (int offset = 1; offset < numThreads(); offset++) {
+            Worker& victim = *mWorkers[(thief + offset) % numThreads()];
+
+            lock_guard<mutex> lock(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                mSteals++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::workerLoop(int worker) {
+        /* A task can only be spawned by a running task, so once nothing is pending
+         * nothing ever will be again.
+         */
+        int spins = 0;
+        while (mPending > 0) {
+            Task task;
+            if (popLocal(worker, task) || steal(worker, task)) {
+                mQueued--;
+                spins = 0;
+                task(worker);
+
+                /* The last task out wakes everyone up so they can leave. */
+                if (--mPending == 0) {
+                    { lock_guard<mutex> lock(mIdleLock); }
+                    mIdle.notify_all();
+                }
+            } else if (++spins < kIdleSpins) {
+                this_thread::yield();
+            } else {
+                unique_lock<mutex> lock(mIdleLock);
+                mIdle.wait(lock, [&] { return mPending == 0 || mQueued > 0; });
+                spins = 0;
+            }
+        }
+    }
+}
+
+
+/* * * * * * Test Cases Below This Point * * * * * */
+#include "GUI/SimpleTest.h"
+
+STUDENT_TEST("WorkStealingPool runs every transitively spawned task exactly once.") {
+    Disaster::WorkStealingPool pool(4);
+    std::atomic<int> leaves(0);
+
+    /* A binary tree of tasks of depth 10 has 2^10 leaves. */
+    std::function<void(int, int)> expand = [&](int worker, int depth) {
+        if (depth == 10) {
+            leaves++;
+            return;
+        }
+        for (int child = 0; child < 2; child++) {
+            pool.spawn(worker, [&, depth](int thief) {
+                expand(thief, depth + 1);
+            });
+        }
+    };
+
+    pool.run([&](int worker) {
+        expand(worker, 0);
+    });
+    EXPECT_EQUAL(leaves.load(), 1024);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Disaster {
+    /**
+     * A pool of workers for recursive, fork-style parallelism. Each worker owns a
+     * deque of tasks: it pushes and pops its own work at the back (so it runs the most
+     * recently created, smallest tasks first) and, when it runs dry, steals from the
+     * front of another worker's deque (taking the oldest, largest tasks).
+     * <p>
+     * Tasks receive the index of the worker running them, so they can spawn follow-up
+     * tasks onto that worker's deque and use per-worker scratch state. Workers with
+     * nothing to do spin briefly in case work turns up, then sleep until it does.
+     */
+    class WorkStealingPool {
+    public:
+        using Task = std::function<void(int worker)>;
+
+        /* Creates a pool with the given number of workers; 0 means one per core. */
+        explicit WorkStealingPool(int numThreads = 0);
+
+        int numThreads() const {
+            return int(mWorkers.size());
+        }
+
+        /* Runs the given task on worker 0 and blocks until it and every task spawned
+         * from it, directly or indirectly, has finished.
+         */
+        void run(Task root);
+
+        /* Queues a task on the given worker's deque. Only call this from inside a task. */
+        void spawn(int worker, Task task);
+
+        /* How many tasks are waiting in the given worker's deque. */
+        int queued(int worker);
+
+        /* Number of tasks taken from another worker's deque during the last run. */
+        long long steals() const {
+            return mSteals;
+        }
+
+    private:
+        struct Worker {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Worker>> mWorkers;
+        std::atomic<long long> mPending{0};  // Tasks queued or running
+        std::atomic<long long> mQueued{0};   // Tasks sitting in some deque
+        std::atomic<long long> mSteals{0};
+
+        std::mutex mIdleLock;                // Guards sleeping on mIdle
+        std::condition_variable mIdle;       // Signaled when work is queued or the run ends
+
+        bool popLocal(int worker, Task& task);
+        bool steal(int thief, Task& task);
+        void workerLoop(int worker);
+    };
+}
@@ -1,83 +1,117 @@
 #include "DisasterPlanning.h"
+#include "Disaster/Certificate.h"
+#include "Disaster/Resilience.h"
+#include "Disaster/RoadGraph.h"
+#include "Disaster/Solver.h"
+#include "error.h"
 using namespace std;
-#include <Map>
-#include <Set>
-#include <Optional>
+
+namespace {
+    /* Translates a certificate from city ids back into city names. */
+    SupplyCertificate toSupplyCertificate(const Disaster::RoadGraph& graph,
+                                          const Disaster::CoverCertificate& certificate) {
+        SupplyCertificate result;
+        result.bound = certificate.bound;
+        if (certificate.kind == Disaster::CertificateKind::PACKING) {
+            result.packing = graph.namesOf(certificate.packing);
+        } else {
+            for (Disaster::CityId city = 0; city < Disaster::CityId(graph.numCities()); city++) {
+                if (certificate.weights[city] > 0) result.weights[graph.nameOf(city)] = certificate.weights[city];
+            }
+        }
+        return result;
+    }
+
+    /* The wrappers below solve on a single thread, so the same network always gets
+     * the same answer back.
+     */
+    Disaster::SolverOptions repeatableOptions() {
+        Disaster::SolverOptions options;
+        options.threads = 1;
+        return options;
+    }
+}
 
 Optional<Set<string>> placeEmergencySupplies(const Map<string, Set<string>>& roadNetwork, int numCities) {
     if (numCities < 0) {
         error("Number of cities cannot be negative.");
     }
 
-    Set<string> coveredCities;
-    Set<string> allCities = roadNetwork.keys();
-    return placeEmergencySuppliesHelper(roadNetwork, numCities, coveredCities, allCities);
-}
+    /* Intern the network once; the search itself only ever sees city ids. */
+    Disaster::RoadGraph graph(roadNetwork);
 
-Optional<Set<string>> placeEmergencySuppliesHelper(const Map<string, Set<string>>& roadNetwork,
-                                                   int numCities,
-                                                   Set<string> coveredCities,
-                                                   const Set<string>& remainingCities) {
-    // Check if all cities are covered
-    if (remainingCities.isEmpty()) {
-        return Set<string>(); // Return empty set as we have covered all
+    vector<Disaster::CityId> cover;
+    if (!Disaster::findCoverWithin(graph, numCities, cover, repeatableOptions())) {
+        return Nothing;
     }
+    return graph.namesOf(cover);
+}
 
-    // Pick an uncovered city
-    string uncoveredCity = *remainingCities.first();
-
-    // Try covering this city by placing supplies in it or in its neighbors
-    Set<string> neighbors = roadNetwork[uncoveredCity];
+Optional<Set<string>> placeEmergencySupplies(const Map<string, Set<string>>& roadNetwork,
+                                             int numCities, SupplyCertificate& certificate) {
+    if (numCities < 0) {
+        error("Number of cities cannot be negative.");
+    }
 
-    // Option 1: Place supplies in the uncovered city itself
-    if (numCities > 0) {
-        coveredCities.add(uncoveredCity);
-        Set<string> newRemainingCities = remainingCities - Set<string>{uncoveredCity};
-        for (const string& neighbor : neighbors) {
-            coveredCities.add(neighbor);
-        }
+    Disaster::RoadGraph graph(roadNetwork);
 
-        Optional<Set<string>> result = placeEmergencySuppliesHelper(roadNetwork, numCities - 1, coveredCities, newRemainingCities);
-        if (result != Nothing) {
-            result.value().add(uncoveredCity); // Include the city we just covered
-            return result; // Successful coverage
-        }
+    /* The packing is nearly free, so it gets a chance to refute the budget up front. */
+    Disaster::CoverProblem problem(graph);
+    Disaster::CoverCertificate proof = Disaster::packingCertificate(problem);
+    certificate = toSupplyCertificate(graph, proof);
+    if (proof.bound > numCities) {
+        return Nothing;
+    }
 
-        // Backtrack
-        coveredCities.remove(uncoveredCity);
-        for (const string& neighbor : neighbors) {
-            coveredCities.remove(neighbor);
-        }
+    vector<Disaster::CityId> cover;
+    if (Disaster::findCoverWithin(graph, numCities, cover, repeatableOptions())) {
+        return graph.namesOf(cover);
     }
 
-    // Option 2: Place supplies in one of the neighbors
-    for (const string& neighbor : neighbors) {
-        if (numCities > 0 && !coveredCities.contains(neighbor)) {
-            coveredCities.add(neighbor);
-            Set<string> newRemainingCities = remainingCities - Set<string>{uncoveredCity};
-            for (const string& city : roadNetwork[neighbor]) {
-                coveredCities.add(city);
-            }
+    /* The fractional bound is stronger but takes quadratic time, so it's only worked
+     * out once the answer is no and there's a refutation worth strengthening.
+     */
+    Disaster::CoverCertificate fractional = Disaster::fractionalCertificate(problem);
+    if (fractional.bound > proof.bound) certificate = toSupplyCertificate(graph, fractional);
+    return Nothing;
+}
 
-            Optional<Set<string>> result = placeEmergencySuppliesHelper(roadNetwork, numCities - 1, coveredCities, newRemainingCities);
-            if (result != Nothing) {
-                result.value().add(neighbor); // Include the neighbor we just covered
-                return result; // Successful coverage
-            }
+Set<string> minimumEmergencySupplies(const Map<string, Set<string>>& roadNetwork) {
+    return minimumEmergencySupplies(roadNetwork, repeatableOptions());
+}
 
-            // Backtrack
-            coveredCities.remove(neighbor);
-            for (const string& city : roadNetwork[neighbor]) {
-                coveredCities.remove(city);
-            }
-        }
-    }
+Set<string> minimumEmergencySupplies(const Map<string, Set<string>>& roadNetwork,
+                                     const Disaster::SolverOptions& options,
+                                     Disaster::SolverStats* stats) {
+    Disaster::RoadGraph graph(roadNetwork);
+    return graph.namesOf(Disaster::findMinimumCover(graph, options, stats));
+}
 
-    return Nothing; // No successful coverage found
+SupplyPlan minimumEmergencySupplies(const Map<string, Set<string>>& roadNetwork,
+                                    chrono::steady_clock::time_point deadline,
+                                    const atomic<bool>* cancel) {
+    Disaster::RoadGraph graph(roadNetwork);
+    Disaster::SolveResult result = Disaster::findMinimumCoverBy(graph, deadline, cancel, repeatableOptions());
+
+    SupplyPlan plan;
+    plan.cities = graph.namesOf(result.cover);
+    plan.lowerBound = result.lowerBound;
+    switch (result.status) {
+        case Disaster::SolveStatus::OPTIMAL:   plan.status = PlanStatus::OPTIMAL;   break;
+        case Disaster::SolveStatus::FEASIBLE:  plan.status = PlanStatus::FEASIBLE;  break;
+        case Disaster::SolveStatus::TIMED_OUT: plan.status = PlanStatus::TIMED_OUT; break;
+    }
+    return plan;
 }
-    (void) roadNetwork;
-    (void) numCities;
-    return Nothing;
+
+Vector<FailurePlan> roadFailurePlans(const Map<string, Set<string>>& roadNetwork) {
+    Disaster::RoadGraph graph(roadNetwork);
+
+    Vector<FailurePlan> plans;
+    for (const auto& failure: Disaster::roadFailures(graph)) {
+        plans.add({ graph.nameOf(failure.from), graph.nameOf(failure.to), graph.namesOf(failure.cover) });
+    }
+    return plans;
 }
 
 
@@ -118,6 +152,22 @@ bool isCovered(const string& city,
     return false;
 }
 
+/* Builds a rows x cols grid whose cities are named "row,col", with roads between
+ * cities next to each other horizontally or vertically.
+ */
+Map<string, Set<string>> makeGrid(int rows, int cols) {
+    Map<string, Set<string>> grid;
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            string city = to_string(row) + "," + to_string(col);
+            grid[city];
+            if (row + 1 < rows) grid[city] += to_string(row + 1) + "," + to_string(col);
+            if (col + 1 < cols) grid[city] += to_string(row) + "," + to_string(col + 1);
+        }
+    }
+    return makeSymmetric(grid);
+}
+
 /* * * * * * Test Cases Below This Point * * * * * */
 
 STUDENT_TEST("Test placeEmergencySupplies with simple network") {
@@ -134,6 +184,135 @@ STUDENT_TEST("Test placeEmergencySupplies with simple network") {
     assert(result.value().contains("D")); // Expected to cover all cities
 }
 
+STUDENT_TEST("minimumEmergencySupplies finds optimal covers.") {
+    EXPECT_EQUAL(minimumEmergencySupplies({ }), {});
+    EXPECT_EQUAL(minimumEmergencySupplies(makeSymmetric({ { "Solipsist", {} } })), { "Solipsist" });
+
+    /* Greedy picks D first on this map and ends up needing three cities. */
+    EXPECT_EQUAL(minimumEmergencySupplies(makeSymmetric({
+        { "A", { "B" } },
+        { "B", { "C", "D" } },
+        { "C", { "D" } },
+        { "D", { "F", "G" } },
+        { "E", { "F" } },
+        { "F", { "G" } },
+    })), { "B", "F" });
+}
+
+STUDENT_TEST("minimumEmergencySupplies agrees with placeEmergencySupplies on a 5 x 5 grid.") {
+    Map<string, Set<string>> grid = makeGrid(5, 5);
+
+    Set<string> best = minimumEmergencySupplies(grid);
+    EXPECT_EQUAL(best.size(), 7);
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, best));
+    }
+    EXPECT_EQUAL(placeEmergencySupplies(grid, best.size() - 1), Nothing);
+}
+
+STUDENT_TEST("minimumEmergencySupplies can race a portfolio and record who won.") {
+    Map<string, Set<string>> grid = makeGrid(6, 6);
+
+    Disaster::SolverOptions options;
+    options.maxTreewidth = -1;
+    options.backend = Disaster::SolverBackend::PORTFOLIO;
+
+    Disaster::SolverStats stats;
+    Set<string> best = minimumEmergencySupplies(grid, options, &stats);
+    EXPECT_EQUAL(best.size(), 10);
+    for (const string& city: grid) {
+        EXPECT(isCovered(city, grid, best));
+    }
+
+    int races = 0;
+    for (const auto& win: stats.portfolioWins) races += win.second;
+    EXPECT_GREATER_THAN(races, 0);
+}
+
+STUDENT_TEST("placeEmergencySupplies attaches a certificate when the budget is too small.") {
+    /* Three separate roads need one city each, and the packing shows it. */
+    Map<string, Set<string>> roads = makeSymmetric({
+        { "A", { "B" } },
+        { "C", { "D" } },
+        { "E", { "F" } }
+    });
+    SupplyCertificate certificate;
+    EXPECT_EQUAL(placeEmergencySupplies(roads, 2, certificate), Nothing);
+    EXPECT_EQUAL(certificate.bound, 3);
+    EXPECT_EQUAL(certificate.packing.size(), 3);
+
+    EXPECT_NOT_EQUAL(placeEmergencySupplies(roads, 3, certificate), Nothing);
+    EXPECT_EQUAL(certificate.bound, 3);
+
+    /* A 5 x 5 grid needs 7. No packing gets there, but fractional weights do. */
+    Map<string, Set<string>> grid = makeGrid(5, 5);
+
+    EXPECT_EQUAL(placeEmergencySupplies(grid, 6, certificate), Nothing);
+    EXPECT_EQUAL(certificate.bound, 7);
+
+    /* Audit it: no city's supplies reach more than 1 unit of weight. */
+    double total = 0;
+    for (const string& city: certificate.weights) {
+        total += certificate.weights[city];
+    }
+    EXPECT_GREATER_THAN(total, 6);
+    for (const string& city: grid) {
+        double reached = certificate.weights.containsKey(city)? certificate.weights[city] : 0;
+        for (const string& neighbor: grid[city]) {
+            if (certificate.weights.containsKey(neighbor)) reached += certificate.weights[neighbor];
+        }
+        EXPECT_LESS_THAN_OR_EQUAL_TO(reached, 1 + 1e-9);
+    }
+}
+
+STUDENT_TEST("Time-limited minimumEmergencySupplies reports how far it got.") {
+    Map<string, Set<string>> network = makeSymmetric({
+        { "A", { "B" } },
+        { "B", { "C", "D" } },
+        { "C", { "D" } },
+        { "D", { "F", "G" } },
+        { "E", { "F" } },
+        { "F", { "G" } },
+    });
+
+    SupplyPlan plan = minimumEmergencySupplies(network, chrono::steady_clock::now() + chrono::seconds(20));
+    EXPECT(plan.status == PlanStatus::OPTIMAL);
+    EXPECT_EQUAL(plan.cities, { "B", "F" });
+    EXPECT_EQUAL(plan.lowerBound, 2);
+
+    /* Out of time before starting. */
+    plan = minimumEmergencySupplies(network, chrono::steady_clock::now());
+    EXPECT(plan.status == PlanStatus::TIMED_OUT);
+    EXPECT(plan.cities.isEmpty());
+
+    atomic<bool> cancel(true);
+    plan = minimumEmergencySupplies(network, chrono::steady_clock::now() + chrono::seconds(20), &cancel);
+    EXPECT(plan.status == PlanStatus::TIMED_OUT);
+}
+
+STUDENT_TEST("roadFailurePlans covers the network with each road cut.") {
+    Map<string, Set<string>> network = makeSymmetric({
+        { "A", { "B" } },
+        { "B", { "C", "D" } },
+        { "C", { "D" } },
+    });
+
+    /* B covers everything, and still does if only the road between C and D is cut. */
+    Vector<FailurePlan> plans = roadFailurePlans(network);
+    EXPECT_EQUAL(plans.size(), 4);
+    for (const FailurePlan& plan: plans) {
+        EXPECT_LESS_THAN(plan.from, plan.to);
+
+        Map<string, Set<string>> cut = network;
+        cut[plan.from] -= plan.to;
+        cut[plan.to] -= plan.from;
+        for (const string& city: cut) {
+            EXPECT(isCovered(city, cut, plan.cities));
+        }
+        EXPECT_EQUAL(plan.cities.size(), plan.from == "C" && plan.to == "D"? 1 : 2);
+    }
+}
+
 
 
 
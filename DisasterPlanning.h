@@ -1,9 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include "set.h"
 #include "map.h"
+#include "vector.h"
 #include "Demos/optional.h"
+#include "Disaster/Solver.h"
 
 /**
  * Given a transportation grid for a country or region, along with the number of cities where disaster
@@ -27,3 +31,123 @@ Optional<Set<std::string>>
 placeEmergencySupplies(const Map<std::string, Set<std::string>>& roadNetwork,
                        int numCities);
 
+
+/**
+ * Evidence that a road network can't be covered with fewer than bound cities, which can
+ * be checked without any searching. It comes in one of two forms:
+ * <p>
+ * A packing is a set of cities no two of which are the same city, adjacent, or have a
+ * neighbor in common. No single city's supplies can reach two of them, so each needs
+ * supplies of its own.
+ * <p>
+ * Weights put a nonnegative number on each city such that the weights of any city and
+ * its neighbors add up to at most 1. One city's supplies then reach at most 1 unit of
+ * weight, so covering everything takes at least the total weight, rounded up.
+ */
+struct SupplyCertificate {
+    Set<std::string> packing;            // Empty unless the certificate is a packing
+    Map<std::string, double> weights;    // Empty unless the certificate is fractional
+    int bound = 0;                       // Every cover needs at least this many cities
+};
+
+/**
+ * Like placeEmergencySupplies, but also produces a lower-bound certificate for auditing.
+ * A packing is checked before searching, and if it shows that numCities is too few, this
+ * returns Nothing right away. If the search then finds no cover either, the certificate
+ * is upgraded to fractional weights when those prove more. When a cover exists, the
+ * certificate is the packing.
+ *
+ * @param roadNetwork The underlying transportation network.
+ * @param numCities   How many cities you can afford to put supplies in.
+ * @param certificate An outparameter filled in with the strongest certificate found.
+ * @return The cities to choose, if a solution exists.
+ */
+Optional<Set<std::string>>
+placeEmergencySupplies(const Map<std::string, Set<std::string>>& roadNetwork,
+                       int numCities, SupplyCertificate& certificate);
+
+
+/**
+ * Given a transportation grid for a country or region, returns a smallest possible set of
+ * cities in which to stockpile disaster supplies so that each city either has supplies or
+ * is adjacent to a city that does.
+ * <p>
+ * Unlike calling placeEmergencySupplies with increasing budgets, this runs a single
+ * branch-and-bound search that keeps the best solution found so far and prunes anything
+ * that provably can't beat it. The search runs on one thread, so the same network always
+ * gets the same answer.
+ *
+ * @param roadNetwork The underlying transportation network.
+ * @return A minimum-size set of cities that covers the whole network.
+ */
+Set<std::string>
+minimumEmergencySupplies(const Map<std::string, Set<std::string>>& roadNetwork);
+
+/**
+ * Like minimumEmergencySupplies, but with a choice of solver settings, such as which
+ * backend solves the hard parts of the network or whether several race each other.
+ *
+ * @param roadNetwork The underlying transportation network.
+ * @param options     Solver settings.
+ * @param stats       If non-null, receives statistics about the run, including which
+ *                    backends won each portfolio race.
+ * @return A minimum-size set of cities that covers the whole network.
+ */
+Set<std::string>
+minimumEmergencySupplies(const Map<std::string, Set<std::string>>& roadNetwork,
+                         const Disaster::SolverOptions& options,
+                         Disaster::SolverStats* stats = nullptr);
+
+
+/**
+ * How much a time-limited call to minimumEmergencySupplies was able to establish.
+ */
+enum class PlanStatus {
+    OPTIMAL,    // The cities form a smallest possible cover
+    FEASIBLE,   // The cities cover the network, but might not be the fewest possible
+    TIMED_OUT   // Time ran out before any cover was found
+};
+
+/**
+ * The result of a time-limited call to minimumEmergencySupplies.
+ */
+struct SupplyPlan {
+    Set<std::string> cities;  // Where to stockpile supplies; empty if timed out
+    int lowerBound = 0;       // Every cover needs at least this many cities
+    PlanStatus status = PlanStatus::TIMED_OUT;
+};
+
+/**
+ * Like minimumEmergencySupplies, but with a hard time limit. If the search can't prove
+ * its answer optimal before the deadline (or before cancel becomes true), it stops and
+ * reports the best cover found so far together with the best lower bound it proved.
+ *
+ * @param roadNetwork The underlying transportation network.
+ * @param deadline    When to give up.
+ * @param cancel      If non-null, the search gives up soon after this becomes true.
+ * @return The best cover found, a lower bound on the optimum, and whether it's optimal.
+ */
+SupplyPlan
+minimumEmergencySupplies(const Map<std::string, Set<std::string>>& roadNetwork,
+                         std::chrono::steady_clock::time_point deadline,
+                         const std::atomic<bool>* cancel = nullptr);
+
+
+/**
+ * Where to stockpile supplies if one particular road is cut.
+ */
+struct FailurePlan {
+    std::string from, to;     // The cut road, with from alphabetically first
+    Set<std::string> cities;  // A smallest cover of the network without that road
+};
+
+/**
+ * For every road in the network, finds a smallest set of cities in which to stockpile
+ * disaster supplies if that road alone is cut. A cut never lets fewer cities do, and
+ * usually the cities chosen for the intact network still work, so this is much faster
+ * than calling minimumEmergencySupplies once per road.
+ *
+ * @param roadNetwork The underlying transportation network.
+ * @return One plan per road, ordered by the cut road's endpoints.
+ */
+Vector<FailurePlan> roadFailurePlans(const Map<std::string, Set<std::string>>& roadNetwork);